@@ -12,6 +12,12 @@ ConvertMeshToPoints::ConvertMeshToPoints(vsg::ref_ptr<vsgPoints::Settings> setti
 }
 
 
+void ConvertMeshToPoints::addPoints()
+{
+    colors.resize(points.size(), vsg::ubvec4(255, 255, 255, 255));
+    bricks->add(points.data(), colors.data(), points.size());
+}
+
 void ConvertMeshToPoints::applyDraw(uint32_t firstVertex, uint32_t vertexCount, uint32_t firstInstance, uint32_t instanceCount)
 {
     auto& arrayState = *arrayStateStack.back();
@@ -19,16 +25,16 @@ void ConvertMeshToPoints::applyDraw(uint32_t firstVertex, uint32_t vertexCount,
     uint32_t endVertex = firstVertex + vertexCount;
     auto matrix = localToWorld();
 
-    vsg::ubvec4 color(255,255,255,255);
-
     for (uint32_t instanceIndex = firstInstance; instanceIndex < lastIndex; ++instanceIndex)
     {
         if (auto vertices = arrayState.vertexArray(instanceIndex))
         {
+            points.clear();
             for (uint32_t i = firstVertex; i < endVertex; ++i)
             {
-                bricks->add(matrix * vsg::dvec3(vertices->at(i)), color);
+                points.push_back(matrix * vsg::dvec3(vertices->at(i)));
             }
+            addPoints();
         }
     }
 }
@@ -40,18 +46,18 @@ void ConvertMeshToPoints::applyDrawIndexed(uint32_t firstIndex, uint32_t indexCo
     uint32_t endIndex = firstIndex + indexCount;
     auto matrix = localToWorld();
 
-    vsg::ubvec4 color(255,255,255,255);
-
     if (ushort_indices)
     {
         for (uint32_t instanceIndex = firstInstance; instanceIndex < lastIndex; ++instanceIndex)
         {
             if (auto vertices = arrayState.vertexArray(instanceIndex))
             {
+                points.clear();
                 for (uint32_t i = firstIndex; i < endIndex; ++i)
                 {
-                    bricks->add(matrix * vsg::dvec3(vertices->at(ushort_indices->at(i))), color);
+                    points.push_back(matrix * vsg::dvec3(vertices->at(ushort_indices->at(i))));
                 }
+                addPoints();
             }
         }
     }
@@ -61,10 +67,12 @@ void ConvertMeshToPoints::applyDrawIndexed(uint32_t firstIndex, uint32_t indexCo
         {
             if (auto vertices = arrayState.vertexArray(instanceIndex))
             {
+                points.clear();
                 for (uint32_t i = firstIndex; i < endIndex; ++i)
                 {
-                    bricks->add(matrix * vsg::dvec3(vertices->at(uint_indices->at(i))), color);
+                    points.push_back(matrix * vsg::dvec3(vertices->at(uint_indices->at(i))));
                 }
+                addPoints();
             }
         }
     }
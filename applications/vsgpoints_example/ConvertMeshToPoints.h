@@ -15,10 +15,15 @@ public:
     vsg::ref_ptr<const vsg::ushortArray> ushort_indices;
     vsg::ref_ptr<const vsg::uintArray> uint_indices;
 
+    // scratch buffers used to pass points to Bricks::add() a draw at a time
+    std::vector<vsg::dvec3> points;
+    std::vector<vsg::ubvec4> colors;
+
     /// get the current local to world matrix stack
     std::vector<vsg::dmat4>& localToWorldStack() { return arrayStateStack.back()->localToWorldStack; }
     vsg::dmat4 localToWorld() const { auto matrixStack = arrayStateStack.back()->localToWorldStack; return matrixStack.empty() ? vsg::dmat4{} : matrixStack.back(); }
 
+    void addPoints();
     void applyDraw(uint32_t firstVertex, uint32_t vertexCount, uint32_t firstInstance, uint32_t instanceCount);
     void applyDrawIndexed(uint32_t firstIndex, uint32_t indexCount, uint32_t firstInstance, uint32_t instanceCount);
 
@@ -6,7 +6,10 @@
 
 #include <vsgPoints/BIN.h>
 #include <vsgPoints/AsciiPoints.h>
+#include <vsgPoints/PointsTile.h>
+#include <vsgPoints/TileArchive.h>
 #include <vsgPoints/create.h>
+#include <vsgPoints/read.h>
 
 #include "ConvertMeshToPoints.h"
 
@@ -46,6 +49,8 @@ int main(int argc, char** argv)
 
     options->add(vsgPoints::BIN::create());
     options->add(vsgPoints::AsciiPoints::create());
+    options->add(vsgPoints::TileArchive::create());
+    options->add(vsgPoints::PointsTile::create());
 
 #ifdef vsgXchange_all
     // add vsgXchange's support for reading and writing 3rd party file formats
@@ -83,13 +88,43 @@ int main(int argc, char** argv)
     arguments.read("-b", settings->numPointsPerBlock);
     arguments.read("-p", settings->precision);
     arguments.read("-t", settings->transition);
+    arguments.read("--pixel-error", settings->pixelError);
+    arguments.read("--screen-height", settings->screenHeight);
     arguments.read("--ps", settings->pointSize);
     arguments.read("--bits", settings->bits);
+    if (arguments.read("--no-mmap")) settings->memoryMapFiles = false;
+    if (arguments.read("--two-pass")) settings->twoPassRead = true;
+    if (size_t budget; arguments.read("--memory-budget", budget)) settings->memoryBudget = budget * 1024 * 1024;
+    arguments.read("--scratch", settings->scratchPath);
+    arguments.read("--subtree-levels", settings->subtreeLevels);
+    if (arguments.read("--subdivide")) settings->subdivideBricks = true;
+    arguments.read("--pack", settings->packThreshold);
+    if (arguments.read("--indirect"))
+    {
+        // the packed tiles are drawn with a multi draw indirect using a per brick firstInstance, so enable the features it depends upon
+        settings->drawIndirect = true;
+        windowTraits->deviceFeatures = vsg::DeviceFeatures::create();
+        windowTraits->deviceFeatures->get().multiDrawIndirect = VK_TRUE;
+        windowTraits->deviceFeatures->get().drawIndirectFirstInstance = VK_TRUE;
+    }
+    if (arguments.read("--voxel")) settings->decimation = vsgPoints::DECIMATE_VOXEL;
+    else if (arguments.read("--voxel-average")) settings->decimation = vsgPoints::DECIMATE_VOXEL_AVERAGE;
+    if (arguments.read("--additive")) settings->additive = true;
+    if (arguments.read("--archive")) settings->archiveTiles = true;
+    if (arguments.read("--compress")) settings->compressTiles = true;
+    if (arguments.read("--store-bricks")) settings->storeBricks = true;
+    bool append = arguments.read("--append");
+    if (uint32_t numThreads; arguments.read("--threads", numThreads) && numThreads > 1) settings->operationThreads = vsg::OperationThreads::create(numThreads - 1);
     auto maxPagedLOD = arguments.value(0, "--maxPagedLOD");
     bool convert_mesh = arguments.read("--mesh");
+
+    if (settings->twoPassRead && settings->memoryBudget > 0)
+    {
+        std::cout<<"Warning: --two-pass places all of a file's points in memory before spilling them, so --memory-budget only applies once each file is read."<<std::endl;
+    }
     bool add_model = !arguments.read("--no-model");
 
-    if (arguments.read("--plod")) settings->createType = vsgPoints::CREATE_PAGEDLOD;
+    if (arguments.read("--plod") || append) settings->createType = vsgPoints::CREATE_PAGEDLOD;
     else if (arguments.read("--lod")) settings->createType = vsgPoints::CREATE_LOD;
     else if (arguments.read("--flat")) settings->createType = vsgPoints::CREATE_FLAT;
 
@@ -98,7 +133,7 @@ int main(int argc, char** argv)
     if (outputFilename)
     {
         settings->path =  vsg::filePath(outputFilename)/vsg::simpleFilename(outputFilename);
-        settings->extension = vsg::fileExtension(outputFilename);
+        settings->extension = arguments.read("--raw-tiles") ? vsg::Path(vsgPoints::PointsTile::tileExtension()) : vsg::fileExtension(outputFilename);
         writeOnly = !arguments.read({"-v", "--viewer"});
     }
     else
@@ -112,46 +147,47 @@ int main(int argc, char** argv)
 
     auto group = vsg::Group::create();
 
+    vsg::Paths filenames;
     for (int i = 1; i < argc; ++i)
     {
-        vsg::Path filename = arguments[i];
+        filenames.push_back(arguments[i]);
+    }
+
+    // read all the files concurrently into a single Bricks so that overlapping scans share one spatial hierarchy
+    auto before_read = vsg::clock::now();
+    std::vector<vsg::ref_ptr<vsg::Node>> nodes;
+    auto bricks = vsgPoints::readBricks(filenames, settings, options, &nodes);
+    double time_to_read = std::chrono::duration<double, std::chrono::seconds::period>(vsg::clock::now() - before_read).count();
+    std::cout<<"Time to read points = "<<time_to_read<<" seconds"<<std::endl;
+
+    for (auto& node : nodes)
+    {
+        if (convert_mesh)
+        {
+            ConvertMeshToPoints convert(settings);
+            node->accept(convert);
 
-        auto before_read = vsg::clock::now();
-        auto object = vsg::read(filename, options);
-        double time_to_read = std::chrono::duration<double, std::chrono::seconds::period>(vsg::clock::now() - before_read).count();
-        std::cout<<"Time to read points = "<<time_to_read<<" seconds"<<std::endl;
+            std::cout<<"Converted mesh to "<<format_number(convert.bricks->count())<<" points."<<std::endl;
+            if (!bricks->merge(*convert.bricks)) std::cout<<"Warning: unable to restore spilled points of converted mesh."<<std::endl;
+        }
 
-        if (auto node = object.cast<vsg::Node>())
+        if (add_model)
         {
-            if (convert_mesh)
-            {
-                ConvertMeshToPoints convert(settings);
-                node->accept(convert);
-                auto bricks = convert.bricks;
-
-                std::cout<<"Converted mesh to "<<format_number(bricks->count())<<" points."<<std::endl;
-                if (auto scene = vsgPoints::createSceneGraph(bricks, settings))
-                {
-                    group->addChild(scene);
-                }
-            }
-
-            if (add_model)
-            {
-                group->addChild(node);
-            }
+            group->addChild(node);
         }
-        else if (auto bricks = object.cast<vsgPoints::Bricks>())
+    }
+
+    if (!bricks->empty())
+    {
+        std::cout<<"Read "<<format_number(bricks->count())<<" points."<<std::endl;
+        auto before_create = vsg::clock::now();
+        auto scene = append ? vsgPoints::appendToPagedLOD(bricks, settings) : vsgPoints::createSceneGraph(bricks, settings);
+        if (scene)
         {
-            std::cout<<"Read "<<format_number(bricks->count())<<" points."<<std::endl;
-            auto before_create = vsg::clock::now();
-            if (auto scene = vsgPoints::createSceneGraph(bricks, settings))
-            {
-                group->addChild(scene);
-            }
-            double time_to_create = std::chrono::duration<double, std::chrono::seconds::period>(vsg::clock::now() - before_create).count();
-            std::cout<<"Time to create scene graph = "<<time_to_create<<" seconds"<<std::endl;
+            group->addChild(scene);
         }
+        double time_to_create = std::chrono::duration<double, std::chrono::seconds::period>(vsg::clock::now() - before_create).count();
+        std::cout<<"Time to create scene graph = "<<time_to_create<<" seconds"<<std::endl;
     }
 
     if (group->children.empty())
@@ -12,8 +12,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 </editor-fold> */
 
+#include <vsg/commands/DrawIndirectCommand.h>
+#include <vsg/core/Array.h>
+
 #include <vsgPoints/Settings.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace vsgPoints
 {
 #pragma pack(1)
@@ -28,18 +34,181 @@ namespace vsgPoints
 
     using Key = vsg::ivec4;
 
+    /// the points of several bricks packed into a single set of arrays, with the per brick vsg_PositionScale and vsg_PointSize values
+    /// held as instances and a draw command per non empty brick selecting its range of points and its instance.
+    struct PackedBricks
+    {
+        vsg::ref_ptr<vsg::Data> vertices;
+        vsg::ref_ptr<vsg::ubvec4Array> colors;
+        vsg::ref_ptr<vsg::vec3Array> normals;
+        vsg::ref_ptr<vsg::vec4Array> positionScales;
+        vsg::ref_ptr<vsg::vec2Array> pointSizes;
+        vsg::ref_ptr<vsg::DrawIndirectCommandArray> drawCommands;
+        vsg::dbox bound;
+    };
+
     class VSGPOINTS_DECLSPEC Brick : public vsg::Inherit<vsg::Object, Brick>
     {
     public:
-        Brick();
-
-        std::vector<PackedPoint> points;
+        explicit Brick(uint32_t in_bits = 10);
+
+        /// number of bits per vertex component, 8, 10 or 16.
+        const uint32_t bits;
+
+        /// vertices held in the GPU vertex format for bits, a ubvec3Array for 8 bits, A2R10G10B10 packed uintArray for 10 bits
+        /// or usvec3Array for 16 bits, along with the matching colors. The arrays may have capacity beyond the size() points in use.
+        vsg::ref_ptr<vsg::Data> vertices;
+        vsg::ref_ptr<vsg::ubvec4Array> colors;
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        size_t capacity() const { return colors ? colors->size() : 0; }
+
+        /// make sure there is capacity for at least numPoints points.
+        void reserve(size_t numPoints);
+
+        /// resize to numPoints points. Shrinking retains the capacity, growing allocates exactly numPoints with the new points left for the caller to set().
+        void resize(size_t numPoints);
+
+        /// release any capacity beyond size() so the arrays can be passed directly to the GPU.
+        void trim();
+
+        void add(const vsg::usvec3& v, const vsg::ubvec4& c)
+        {
+            if (_size == capacity()) reserve(std::max(size_t(16), _size * 2));
+            setVertex(_size, v);
+            (*colors)[_size++] = c;
+        }
+
+        void add(const PackedPoint& point) { add(point.v, point.c); }
+
+        /// append all the points of rhs.
+        void append(const Brick& rhs);
+
+        vsg::usvec3 vertex(size_t i) const
+        {
+            switch (bits)
+            {
+            case (8): {
+                auto& v = static_cast<const vsg::ubvec3*>(_vertexData)[i];
+                return vsg::usvec3(v.x, v.y, v.z);
+            }
+            case (10): {
+                uint32_t v = static_cast<const uint32_t*>(_vertexData)[i];
+                return vsg::usvec3(static_cast<uint16_t>((v >> 20) & 0x3ff), static_cast<uint16_t>((v >> 10) & 0x3ff), static_cast<uint16_t>(v & 0x3ff));
+            }
+            default:
+                return static_cast<const vsg::usvec3*>(_vertexData)[i];
+            }
+        }
+
+        void setVertex(size_t i, const vsg::usvec3& v)
+        {
+            _minVertex.set(std::min(_minVertex.x, v.x), std::min(_minVertex.y, v.y), std::min(_minVertex.z, v.z));
+            _maxVertex.set(std::max(_maxVertex.x, v.x), std::max(_maxVertex.y, v.y), std::max(_maxVertex.z, v.z));
+
+            writeVertex(i, v);
+        }
+
+        /// write the vertex without updating minVertex() and maxVertex(), so threads may write to different indices of the same brick concurrently.
+        /// Call expandVertexBound() for the written range once they have finished.
+        void writeVertex(size_t i, const vsg::usvec3& v)
+        {
+            switch (bits)
+            {
+            case (8):
+                static_cast<vsg::ubvec3*>(_vertexData)[i].set(static_cast<uint8_t>(v.x), static_cast<uint8_t>(v.y), static_cast<uint8_t>(v.z));
+                break;
+            case (10):
+                static_cast<uint32_t*>(_vertexData)[i] = 3 << 30 | (static_cast<uint32_t>(v.x) << 20) | (static_cast<uint32_t>(v.y) << 10) | static_cast<uint32_t>(v.z);
+                break;
+            default:
+                static_cast<vsg::usvec3*>(_vertexData)[i] = v;
+                break;
+            }
+        }
+
+        PackedPoint point(size_t i) const { return PackedPoint{vertex(i), (*colors)[i]}; }
+
+        void set(size_t i, const PackedPoint& point)
+        {
+            setVertex(i, point.v);
+            (*colors)[i] = point.c;
+        }
+
+        /// write the point without updating minVertex() and maxVertex(), see writeVertex().
+        void write(size_t i, const PackedPoint& point)
+        {
+            writeVertex(i, point.v);
+            (*colors)[i] = point.c;
+        }
+
+        /// bound of the points, including any spilled, in the brick's quantized units. Maintained as vertices are set so the bound of a brick
+        /// is available without visiting its points, empty bricks have minVertex() greater than maxVertex().
+        const vsg::usvec3& minVertex() const { return _minVertex; }
+        const vsg::usvec3& maxVertex() const { return _maxVertex; }
+
+        /// recompute minVertex() and maxVertex() from the points held in memory, required once points have been removed or written directly to the vertex array.
+        void computeVertexBound();
+
+        /// expand minVertex() and maxVertex() to include the count points starting at first, required once points have been written with write() or writeVertex().
+        void expandVertexBound(size_t first, size_t count);
+
+        /// file that points are spilled to, assigned by Bricks::spill().
+        vsg::Path spillFilename;
+
+        /// number of points held in spillFilename rather than in memory.
+        size_t numSpilled() const { return _numSpilled; }
+
+        /// bytes of memory used by the vertex and color arrays.
+        size_t memoryUsed() const;
+
+        /// append the points held in memory to spillFilename and release the arrays. Returns the number of bytes released.
+        size_t spill();
+
+        /// read back any spilled points, ahead of those held in memory, and remove the spill file. Returns false if the spill file can't be read.
+        bool restore();
+
+        /// release all the points, both those held in memory and spilled.
+        void clear();
+
+        /// reorder the points so that point i takes the value of the previous point order[i].
+        void reorder(const std::vector<uint32_t>& order);
+
+        /// bound of the points, positioned as createRendering() positions them for key, computed from minVertex() and maxVertex().
+        vsg::dbox computeBound(const Settings& settings, Key key) const;
 
         vsg::ref_ptr<vsg::Node> createRendering(const Settings& settings, const vsg::vec4& positionScale, const vsg::vec2& pointSize);
+
+        /// create a draw for the count points starting at first, sharing the brick's vertex and color arrays.
+        vsg::ref_ptr<vsg::Node> createRendering(const Settings& settings, size_t first, size_t count, const vsg::vec4& positionScale, const vsg::vec2& pointSize);
+
+        /// create the rendering for the brick, restoring any spilled points and expanding bound to include its points. If settings.subdivideBricks is true and
+        /// the brick holds more than settings.numPointsPerBlock points its draw is split into octant ranges with a vsg::CullNode per draw, capping
+        /// the points per draw without changing the brick's key.
+        /// Returns a null node if the brick holds no points.
         vsg::ref_ptr<vsg::Node> createRendering(const Settings& settings, Key key, vsg::dbox& bound);
 
+        /// pack the points of bricks into a single set of arrays with a draw command per brick, restoring any spilled points.
+        /// The arrays are left null if the bricks hold no points.
+        static PackedBricks packBricks(const Settings& settings, const std::vector<std::pair<Key, vsg::ref_ptr<Brick>>>& bricks);
+
+        /// create a single node drawing all of bricks from one shared set of arrays, bound once, with a draw per brick selecting its points and its
+        /// positionScale and pointSize instance values. Used to pack bricks holding few points so each doesn't need its own arrays, binding and node.
+        /// With settings.drawIndirect the draws are issued as a single DrawIndirect of the packed drawCommands rather than a Draw per brick.
+        /// Spilled points are restored and bound is expanded to include the points of the bricks. Returns a null node if the bricks hold no points.
+        static vsg::ref_ptr<vsg::Node> createPackedRendering(const Settings& settings, const std::vector<std::pair<Key, vsg::ref_ptr<Brick>>>& bricks, vsg::dbox& bound);
+
     protected:
         virtual ~Brick();
+
+        void _allocate(size_t numPoints);
+
+        size_t _size = 0;
+        size_t _numSpilled = 0;
+        void* _vertexData = nullptr;
+        vsg::usvec3 _minVertex{0xffff, 0xffff, 0xffff};
+        vsg::usvec3 _maxVertex{0, 0, 0};
     };
 
 } // namespace vsgPoints
@@ -0,0 +1,91 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/Bricks.h>
+
+namespace vsgPoints
+{
+
+    /// BrickStore keeps the bricks of every level of a paged database on disk along with the bound of each brick's subtree,
+    /// so that new points can later be added to the database by regenerating just the bricks and tiles they affect.
+    /// Layout:
+    ///   directory/manifest.vsgpbs : char[8] "vsgPBSTR", uint32_t version, double precision, uint32_t bits, uint32_t decimation,
+    ///                               uint8_t additive, uint8_t subdivideBricks, uint64_t numPointsPerBlock, uint64_t packThreshold,
+    ///                               uint8_t drawIndirect, uint8_t compressTiles, ivec3 keyOrigin, uint32_t length, char[length] extension,
+    ///                               uint64_t numEntries, then per entry ivec4 key, uint64_t numPoints, dvec3 boundMin, dvec3 boundMax
+    ///   directory/w/z/y/x.brick   : uint32_t bits, uint64_t numPoints, packed vertices[numPoints], ubvec4 colors[numPoints]
+    class VSGPOINTS_DECLSPEC BrickStore : public vsg::Inherit<vsg::Object, BrickStore>
+    {
+    public:
+        explicit BrickStore(const vsg::Path& in_directory);
+
+        struct Entry
+        {
+            uint64_t numPoints = 0;
+            vsg::dbox bound; /// bound of the brick's subtree, as computed by subtile()
+        };
+
+        const vsg::Path directory;
+
+        double precision = 0.001;
+        uint32_t bits = 10;
+        uint32_t decimation = DECIMATE_STRIDE;
+
+        /// options that determine the layout and format of the tiles, so appending with different ones would mix tiles of different kinds
+        bool additive = false;
+        bool subdivideBricks = false;
+        uint64_t numPointsPerBlock = 0;
+        uint64_t packThreshold = 0;
+        bool drawIndirect = false;
+        bool compressTiles = false;
+
+        vsg::Path extension;
+        vsg::ivec3 keyOrigin; /// offset subtracted from the keys of the points read from files to give the keys used in the database
+        KeyMap<Entry> entries; /// the bricks of all the levels, keyed by Key with the level scale in w
+
+        /// assign the quantization and tile settings of the database.
+        void assign(const Settings& settings, const vsg::ivec3& in_keyOrigin);
+
+        /// return true if the quantization and tile settings match those the database was created with.
+        bool compatible(const Settings& settings) const;
+
+        /// key of the single brick at the coarsest level, the root of the database.
+        Key rootKey() const;
+
+        /// write brick to its file and update its entry. The bricks of finer levels must be added before the bricks of the coarser levels they contribute to.
+        /// If the brick can't be written the manifest is removed, as the store no longer matches it, so the database can't then be appended to.
+        bool add(const Key& key, Brick& brick, const Settings& settings);
+
+        /// add all the bricks of levels, which are ordered finest first.
+        bool add(const Levels& levels, const Settings& settings);
+
+        /// read the brick for key, returns null if it isn't in the store.
+        vsg::ref_ptr<Brick> read(const Key& key) const;
+
+        bool readManifest();
+
+        /// write the manifest, removing the partially written file on failure.
+        bool writeManifest() const;
+
+        /// remove the manifest, so the store is no longer recognized when appending to the database.
+        void removeManifest() const;
+
+        vsg::Path brickFilename(const Key& key) const;
+
+        static const char* storeExtension() { return ".bricks"; }
+    };
+
+} // namespace vsgPoints
+
+EVSG_type_name(vsgPoints::BrickStore)
@@ -16,16 +16,129 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsgPoints/Brick.h>
 
+#include <algorithm>
+#include <functional>
 #include <list>
+#include <vector>
 
 namespace vsgPoints
 {
+    inline size_t hashKey(const Key& key)
+    {
+        uint64_t h = static_cast<uint64_t>(static_cast<uint32_t>(key.x));
+        h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.y);
+        h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.z);
+        h = h * 0x9E3779B97F4A7C15ull + static_cast<uint32_t>(key.w);
+
+        // splitmix64 finalizer to spread the bits of neighbouring keys across the slots
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
+
+    /// open addressing hash map from Key to T, entries are stored contiguously and iterated over in the order they were inserted.
+    template<typename T>
+    class KeyMap
+    {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using Entries = std::vector<value_type>;
+        using iterator = typename Entries::iterator;
+        using const_iterator = typename Entries::const_iterator;
+
+        iterator find(const Key& key)
+        {
+            if (_entries.empty()) return _entries.end();
+
+            auto index = _slots[_findSlot(key)];
+            return index != 0 ? _entries.begin() + (index - 1) : _entries.end();
+        }
+
+        const_iterator find(const Key& key) const
+        {
+            if (_entries.empty()) return _entries.end();
+
+            auto index = _slots[_findSlot(key)];
+            return index != 0 ? _entries.begin() + (index - 1) : _entries.end();
+        }
+
+        mapped_type& operator[](const Key& key)
+        {
+            if (!_slots.empty())
+            {
+                if (auto index = _slots[_findSlot(key)]; index != 0) return _entries[index - 1].second;
+            }
+
+            // keep the load factor at or below 0.5 so probe sequences stay short
+            if ((_entries.size() + 1) * 2 > _slots.size()) _rehash(std::max(size_t(64), _slots.size() * 2));
+
+            _entries.emplace_back(key, mapped_type());
+            _slots[_findSlot(key)] = static_cast<uint32_t>(_entries.size());
+            return _entries.back().second;
+        }
+
+        iterator begin() { return _entries.begin(); }
+        iterator end() { return _entries.end(); }
+
+        const_iterator begin() const { return _entries.begin(); }
+        const_iterator end() const { return _entries.end(); }
+
+        bool empty() const { return _entries.empty(); }
+        size_t size() const { return _entries.size(); }
+
+        void reserve(size_t numEntries)
+        {
+            _entries.reserve(numEntries);
+
+            size_t numSlots = 64;
+            while (numSlots < numEntries * 2) numSlots *= 2;
+            if (numSlots > _slots.size()) _rehash(numSlots);
+        }
+
+        void clear()
+        {
+            _entries.clear();
+            _slots.clear();
+        }
+
+    protected:
+        size_t _findSlot(const Key& key) const
+        {
+            size_t mask = _slots.size() - 1;
+            size_t slot = hashKey(key) & mask;
+            while (_slots[slot] != 0 && _entries[_slots[slot] - 1].first != key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void _rehash(size_t numSlots)
+        {
+            _slots.assign(numSlots, 0);
+            for (size_t i = 0; i < _entries.size(); ++i)
+            {
+                _slots[_findSlot(_entries[i].first)] = static_cast<uint32_t>(i + 1);
+            }
+        }
+
+        Entries _entries;
+        std::vector<uint32_t> _slots; // index + 1 of the entry occupying each slot, 0 for empty slots
+    };
+
+    using BrickMap = KeyMap<vsg::ref_ptr<Brick>>;
+
+    /// number of points per brick, used by the counting pass of a two pass read.
+    using KeyCounts = KeyMap<size_t>;
+
     class VSGPOINTS_DECLSPEC Bricks : public vsg::Inherit<vsg::Object, Bricks>
     {
     public:
         Bricks(vsg::ref_ptr<Settings> in_settings = {});
 
-        using BrickMap = std::map<Key, vsg::ref_ptr<Brick>>;
+        using BrickMap = vsgPoints::BrickMap;
         using key_type = BrickMap::key_type;
         using mapped_type = BrickMap::mapped_type;
         using value_type = BrickMap::value_type;
@@ -33,27 +146,92 @@ namespace vsgPoints
         using const_iterator = BrickMap::const_iterator;
 
         vsg::ref_ptr<Settings> settings;
-        BrickMap bricks;
 
         void add(const vsg::dvec3& v, const vsg::ubvec4& c);
 
-        iterator find(Key key) { return bricks.find(key); }
-        const_iterator find(Key key) const { return bricks.find(key); }
+        /// add count points, quantizing them in blocks and updating settings->bound once for the whole batch.
+        void add(const vsg::dvec3* vertices, const vsg::ubvec4* colors, size_t count);
+
+        /// append the points of source bricks to the matching bricks in this Bricks and expand settings->bound to include source.settings->bound.
+        /// Bricks are merged in order so merging the results of consecutive ranges of points gives the same result as adding them serially.
+        /// Returns false if spilled points of source couldn't be read back, in which case just the points it held in memory are merged.
+        bool merge(Bricks& source);
+
+        /// bytes of memory used by the points held in memory by the bricks.
+        size_t memoryUsed() const;
+
+        /// spill the largest bricks to files in local_settings.scratchPath until no more than maxMemory bytes of points are held in memory.
+        void spill(const Settings& local_settings, size_t maxMemory);
+
+        /// callback passed blocks of points by a BlockReader.
+        using BlockFunction = std::function<void(const vsg::dvec3* vertices, const vsg::ubvec4* colors, size_t count)>;
+
+        /// reads range i of a seekable source, passing its points in order to the BlockFunction. Must give the same points each time it's called.
+        using BlockReader = std::function<void(size_t i, const BlockFunction& block)>;
 
-        mapped_type& operator[](Key key) { return bricks[key]; }
+        /// add the points of numRanges ranges read by reader in two passes. The first pass only counts the points landing in each brick
+        /// so every brick can be allocated once at its exact size, the second quantizes the points again and scatters them directly into place.
+        /// Ranges are read in parallel on settings->operationThreads, with the points of each brick ending up in the same order as adding them serially.
+        void addTwoPass(size_t numRanges, const BlockReader& reader);
 
-        iterator begin() { return bricks.begin(); }
-        iterator end() { return bricks.end(); }
+        /// create an empty Bricks with its own Settings matching the quantization settings of this Bricks,
+        /// used to collect points on a worker thread ready for merging back in with merge().
+        vsg::ref_ptr<Bricks> createEmpty() const;
 
-        const_iterator begin() const { return bricks.begin(); }
-        const_iterator end() const { return bricks.end(); }
+        // the mutable accessors allow the bricks to be replaced, so they drop the cached brick that add() appends points to
+        iterator find(Key key)
+        {
+            _currentBrick = nullptr;
+            return _bricks.find(key);
+        }
+        const_iterator find(Key key) const { return _bricks.find(key); }
 
-        bool empty() const { return bricks.empty(); }
+        mapped_type& operator[](Key key)
+        {
+            _currentBrick = nullptr;
+            return _bricks[key];
+        }
 
-        size_t size() const { return bricks.size(); }
+        iterator begin()
+        {
+            _currentBrick = nullptr;
+            return _bricks.begin();
+        }
+        iterator end() { return _bricks.end(); }
+
+        const_iterator begin() const { return _bricks.begin(); }
+        const_iterator end() const { return _bricks.end(); }
+
+        bool empty() const { return _bricks.empty(); }
+
+        size_t size() const { return _bricks.size(); }
+
+        void reserve(size_t numBricks) { _bricks.reserve(numBricks); }
+
+        /// release all the bricks.
+        void clear();
+
+        /// exchange the bricks held by this and rhs, leaving their settings unchanged.
+        void swap(Bricks& rhs);
 
         // number of points
         size_t count() const;
+
+        using SortedBricks = std::vector<std::pair<Key, vsg::ref_ptr<Brick>>>;
+
+        /// return the bricks sorted by Key, used where traversal order must not depend on the order the bricks were inserted in.
+        /// Each call copies and sorts the bricks, O(n log n) in the number of bricks, so callers iterating over a level should call it once and reuse the result.
+        SortedBricks sorted() const;
+
+    protected:
+        BrickMap _bricks;
+
+        // brick that the last point was added to, consecutive points from scanners usually land in the same brick
+        Key _currentKey;
+        Brick* _currentBrick = nullptr;
+
+        // estimate of the bytes of points held in memory, used to decide when to spill when settings->memoryBudget is set
+        size_t _memoryEstimate = 0;
     };
 
     using Levels = std::list<vsg::ref_ptr<Bricks>>;
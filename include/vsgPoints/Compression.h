@@ -0,0 +1,44 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/maths/vec4.h>
+
+#include <vsgPoints/Export.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace vsgPoints
+{
+
+    /// append value to out as a LEB128 variable length integer.
+    extern VSGPOINTS_DECLSPEC void writeVarint(std::vector<uint8_t>& out, uint64_t value);
+
+    /// read a LEB128 variable length integer, advancing ptr. Returns false if the data ends before the value does.
+    extern VSGPOINTS_DECLSPEC bool readVarint(const uint8_t*& ptr, const uint8_t* end, uint64_t& value);
+
+    /// append data to out as a stream entropy coded by an order-0 rANS coder, including the symbol frequencies required to decode it.
+    extern VSGPOINTS_DECLSPEC void entropyEncode(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+    /// decode a stream written by entropyEncode(), advancing ptr. Returns false if the stream is corrupt or would decode to more than maxSize bytes.
+    extern VSGPOINTS_DECLSPEC bool entropyDecode(const uint8_t*& ptr, const uint8_t* end, std::vector<uint8_t>& out, size_t maxSize);
+
+    /// compress the vertices, in the GPU format used for the given bits, and colors of a brick, appending the result to out.
+    /// Points are reordered along a Morton curve so that the deltas between their positions and colors are small.
+    extern VSGPOINTS_DECLSPEC void compressBrick(uint32_t bits, uint32_t numPoints, const void* vertices, const vsg::ubvec4* colors, std::vector<uint8_t>& out);
+
+    /// decompress numPoints vertices and colors written by compressBrick(), advancing ptr. Returns false if the data is corrupt.
+    extern VSGPOINTS_DECLSPEC bool decompressBrick(const uint8_t*& ptr, const uint8_t* end, uint32_t bits, uint32_t numPoints, void* vertices, vsg::ubvec4* colors);
+
+} // namespace vsgPoints
@@ -0,0 +1,55 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/core/Inherit.h>
+#include <vsg/io/Path.h>
+
+#include <vsgPoints/Export.h>
+
+namespace vsgPoints
+{
+
+    /// read only memory mapping of a file, used by the readers to walk file contents in place rather than copying through std::ifstream.
+    class VSGPOINTS_DECLSPEC MappedFile : public vsg::Inherit<vsg::Object, MappedFile>
+    {
+    public:
+        /// map the whole of filename, if sequential is true hint to the OS that the file will be read from start to end.
+        explicit MappedFile(const vsg::Path& filename, bool sequential = true);
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool valid() const { return _data != nullptr; }
+
+        const uint8_t* data() const { return _data; }
+        size_t size() const { return _size; }
+
+        const uint8_t* begin() const { return _data; }
+        const uint8_t* end() const { return _data + _size; }
+
+    protected:
+        virtual ~MappedFile();
+
+        const uint8_t* _data = nullptr;
+        size_t _size = 0;
+
+#if defined(_WIN32)
+        void* _fileHandle = nullptr;
+        void* _mappingHandle = nullptr;
+#endif
+    };
+
+} // namespace vsgPoints
+
+EVSG_type_name(vsgPoints::MappedFile)
@@ -0,0 +1,46 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/ReaderWriter.h>
+
+#include <vsgPoints/Export.h>
+
+namespace vsgPoints
+{
+
+    /// PointsTile ReaderWriter reads and writes the compact .vsgpt tile format used for paged databases. Rather than serializing the
+    /// generic scene graph it stores just the packed vertex and color arrays of each brick along with the PagedLOD/LOD/CullNode/Group
+    /// structure above them, rebuilding the nodes directly on read. Only the subgraphs created by vsgPoints::subtile() are supported.
+    class VSGPOINTS_DECLSPEC PointsTile : public vsg::Inherit<vsg::ReaderWriter, PointsTile>
+    {
+    public:
+        PointsTile();
+
+        vsg::ref_ptr<vsg::Object> read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const override;
+        vsg::ref_ptr<vsg::Object> read(const uint8_t* ptr, size_t size, vsg::ref_ptr<const vsg::Options> options = {}) const override;
+
+        bool write(const vsg::Object* object, const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options = {}) const override;
+        bool write(const vsg::Object* object, std::ostream& fout, vsg::ref_ptr<const vsg::Options> options = {}) const override;
+
+        /// when writing, entropy code the vertices and colors of each brick to reduce tile size at the cost of decoding on read.
+        bool compress = false;
+
+        static const char* tileExtension() { return ".vsgpt"; }
+
+        std::set<vsg::Path> supportedExtensions;
+    };
+
+} // namespace vsgPoints
+
+EVSG_type_name(vsgPoints::PointsTile)
@@ -13,6 +13,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsg/core/Inherit.h>
+#include <vsg/threading/OperationThreads.h>
 
 #include <vsgPoints/Export.h>
 
@@ -26,6 +27,13 @@ namespace vsgPoints
         CREATE_PAGEDLOD, /// generate a PagedLOD scene graph, suitable for large datasets that can't fit entirely in GPU memory
     };
 
+    enum DecimationType
+    {
+        DECIMATE_STRIDE,        /// parent bricks take every 4th point of each of their child bricks
+        DECIMATE_VOXEL,         /// parent bricks keep the first point from their child bricks that lands in each of the parent's voxels
+        DECIMATE_VOXEL_AVERAGE, /// parent bricks keep one point per voxel, with the color averaged from all the child points in that voxel
+    };
+
     struct Settings : public vsg::Inherit<vsg::Object, Settings>
     {
         size_t numPointsPerBlock = 10000;
@@ -34,11 +42,63 @@ namespace vsgPoints
         float pointSize = 4.0f;
         float transition = 0.125f;
 
+        /// when non zero, LOD and PagedLOD refine a brick into its children only once the spacing of its points, projected on to a screen
+        /// screenHeight pixels high, exceeds pixelError pixels, replacing the bound size based transition heuristic.
+        double pixelError = 0.0;
+        double screenHeight = 1080.0;
+
         CreateType createType = CREATE_LOD;
+        DecimationType decimation = DECIMATE_STRIDE;
+
+        /// cap the points per draw by splitting the points of bricks holding more than numPointsPerBlock into octant ranges, each drawn from the
+        /// brick's shared arrays under its own CullNode. Brick keys and the LOD hierarchy are unchanged, bricks aren't refined into finer keys.
+        bool subdivideBricks = false;
+
+        /// when non zero, sibling leaf bricks holding fewer than this many points are packed into a single node drawing them from one shared set of arrays,
+        /// cutting the nodes, array bindings and memory used for the sparse fringes of scans without changing what is rendered
+        size_t packThreshold = 0;
+
+        /// pack all the sibling leaf bricks of each tile into one shared set of arrays drawn with a single multi draw indirect command, rather than
+        /// recording a draw per brick. Requires the multiDrawIndirect and drawIndirectFirstInstance device features to be enabled.
+        /// Packed leaf bricks are each drawn in full by a single draw command, so drawIndirect overrides subdivideBricks for them.
+        bool drawIndirect = false;
+
+        /// move the points selected for a parent brick out of its child bricks, so children are drawn in addition to their parent rather than instead of it
+        /// Parents take every 4th point of their children, the decimation setting isn't applied as merging points into voxels would lose them.
+        bool additive = false;
+
+        /// read point files via memory mapping rather than std::ifstream where the reader and platform support it
+        bool memoryMapFiles = true;
+
+        /// read memory mapped files twice, first counting the points in each brick so bricks are allocated once at their exact size, then placing the points.
+        /// All of a file's points are placed in memory before any are spilled, so memoryBudget only bounds the memory used once the file is read.
+        bool twoPassRead = false;
+
+        /// write CREATE_PAGEDLOD tiles into a single path + ".vsgpa" archive rather than a file per tile, read back via the TileArchive ReaderWriter
+        bool archiveTiles = false;
+
+        /// entropy code the brick positions and colors of tiles written in the .vsgpt format, typically reducing them to a quarter of the size
+        bool compressTiles = false;
+
+        /// when non zero, CREATE_PAGEDLOD databases are built one subtree of this many levels at a time, releasing each subtree's bricks once its tiles are written.
+        /// The full resolution bricks are held until their subtree is built, so combine with memoryBudget to also bound the memory they use.
+        uint32_t subtreeLevels = 0;
+
+        /// with CREATE_PAGEDLOD, also write the bricks of every level to a path + ".bricks" BrickStore so that new points can later be added
+        /// to the database with appendToPagedLOD(), regenerating only the bricks and tiles they affect
+        bool storeBricks = false;
+
+        /// when non zero, the approximate number of bytes of points to hold in memory while reading and building levels, beyond which the largest
+        /// bricks are spilled to files in scratchPath and read back as required. With CREATE_PAGEDLOD bricks are released once their tile is created.
+        size_t memoryBudget = 0;
+
+        /// directory that bricks are spilled to, within a subdirectory unique to the process that is removed when it exits. Defaults to the system temporary directory.
+        vsg::Path scratchPath;
 
         vsg::Path path;
         vsg::Path extension = ".vsgb";
-        vsg::ref_ptr<vsg::Options> options;
+        vsg::ref_ptr<vsg::Options> options;                   /// when options->sharedObjects is assigned, constant arrays and the state of datasets with matching settings are shared
+        vsg::ref_ptr<vsg::OperationThreads> operationThreads; /// when assigned, reading and scene graph creation is distributed across these threads
         vsg::dvec3 offset;
         vsg::dbox bound;
     };
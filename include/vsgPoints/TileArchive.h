@@ -0,0 +1,103 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/ReaderWriter.h>
+
+#include <vsgPoints/Export.h>
+#include <vsgPoints/MappedFile.h>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace vsgPoints
+{
+
+    /// Archive file layout:
+    ///   header : char[8] "vsgPTARC", uint32_t version
+    ///   tiles  : serialized tiles, back to back in the order of their names
+    ///   index  : uint64_t numTiles, then per tile uint32_t nameLength, char[nameLength] name, uint64_t offset, uint64_t size
+    ///   footer : uint64_t indexOffset, char[8] "vsgPTARC"
+    struct TileArchiveEntry
+    {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    /// TileArchiveWriter writes serialized tiles to a single archive file.
+    /// add() may be called concurrently, serialization runs in parallel and only the append to a staging file alongside the archive is serialized.
+    /// close() then copies the tiles into the archive in name order followed by the index, so the archive doesn't depend on the order tiles were added in.
+    class VSGPOINTS_DECLSPEC TileArchiveWriter : public vsg::Inherit<vsg::Object, TileArchiveWriter>
+    {
+    public:
+        /// tiles are serialized with writer, or if not assigned the PointsTile or VSG ReaderWriter depending upon extension.
+        TileArchiveWriter(const vsg::Path& in_filename, const vsg::Path& in_extension, vsg::ref_ptr<const vsg::ReaderWriter> in_writer = {});
+
+        const vsg::Path filename;
+        const vsg::Path extension;
+        vsg::ref_ptr<const vsg::ReaderWriter> writer;
+
+        /// file the tiles are appended to as they're added, removed when closed
+        vsg::Path stagingFilename() const { return vsg::Path(filename.string() + ".staging"); }
+
+        bool valid() const { return _staging.good(); }
+
+        /// serialize object with the writer and append it to the staging file as tile.
+        bool add(const std::string& tile, const vsg::Object* object);
+
+        /// name used to refer to the tile from PagedLOD::filename. Tiles referenced from the root of the database use the archive's full path,
+        /// those referenced from within other tiles are relative to the directory containing the archive.
+        vsg::Path tileFilename(const std::string& tile, bool root) const;
+
+        /// write the archive from the staged tiles, then the index and footer. Returns false if writing them, or any of the tiles added, failed.
+        bool close();
+
+    protected:
+        virtual ~TileArchiveWriter();
+
+        std::mutex _mutex;
+        std::fstream _staging;
+        vsg::ref_ptr<vsg::Options> _options;
+        std::map<std::string, TileArchiveEntry> _index;
+        bool _failed = false;
+    };
+
+    /// TileArchive ReaderWriter serves filenames of the form path/archive.vsgpa/tile by looking up the tile in the archive index
+    /// and deserializing it directly from the memory mapped archive. Opened archives are kept open for subsequent reads.
+    class VSGPOINTS_DECLSPEC TileArchive : public vsg::Inherit<vsg::ReaderWriter, TileArchive>
+    {
+    public:
+        TileArchive();
+
+        vsg::ref_ptr<vsg::Object> read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const override;
+
+        static const char* archiveExtension() { return ".vsgpa"; }
+
+    protected:
+        struct Archive : public vsg::Inherit<vsg::Object, Archive>
+        {
+            vsg::ref_ptr<MappedFile> mappedFile;
+            std::map<std::string, TileArchiveEntry> index;
+        };
+
+        vsg::ref_ptr<Archive> _open(const vsg::Path& filename) const;
+
+        mutable std::mutex _mutex;
+        mutable std::map<vsg::Path, vsg::ref_ptr<Archive>> _archives;
+    };
+
+} // namespace vsgPoints
+
+EVSG_type_name(vsgPoints::TileArchiveWriter)
+EVSG_type_name(vsgPoints::TileArchive)
@@ -14,17 +14,53 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsg/nodes/Node.h>
 
+#include <vsgPoints/BrickStore.h>
 #include <vsgPoints/Bricks.h>
 
+#include <map>
+
 namespace vsgPoints
 {
+    class TileArchiveWriter;
 
     /// create a scene graph from Bricks using the Setttings as a guide to the type of scene graph to create.
     extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> createSceneGraph(vsg::ref_ptr<vsgPoints::Bricks> bricks, vsg::ref_ptr<vsgPoints::Settings> settings);
 
+    /// generate the level above source in destination. Returns false if destination is left empty or spilled points couldn't be read back.
     extern VSGPOINTS_DECLSPEC bool generateLevel(vsgPoints::Bricks& source, vsgPoints::Bricks& destination, const vsgPoints::Settings& settings);
     extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::StateGroup> createStateGroup(const vsgPoints::Settings& settings);
-    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> subtile(vsgPoints::Settings& settings, vsgPoints::Levels::reverse_iterator level_itr, vsgPoints::Levels::reverse_iterator end_itr, vsgPoints::Key key, vsg::dbox& bound, bool root = false);
-    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> createPagedLOD(vsgPoints::Levels& levels, vsgPoints::Settings& settings);
+
+    /// geometric error of the brick at key holding numPoints points within bound, estimated as the spacing of its points across the two largest
+    /// dimensions of the bound, as scans sample surfaces, and no finer than the precision the brick's level quantizes its points to.
+    extern VSGPOINTS_DECLSPEC double geometricError(const vsgPoints::Settings& settings, const vsgPoints::Key& key, const vsg::dbox& bound, size_t numPoints);
+
+    /// LOD minimumScreenHeightRatio at which a node with a bounding sphere of radius should refine, so that geometricError projects
+    /// to settings.pixelError pixels on a screen settings.screenHeight pixels high.
+    extern VSGPOINTS_DECLSPEC double screenSpaceErrorRatio(const vsgPoints::Settings& settings, double geometricError, double radius);
+
+    /// nodes and bounds of subtrees that have already been created, keyed by the Key of the subtree's root brick.
+    using SubtreeNodes = std::map<vsgPoints::Key, std::pair<vsg::ref_ptr<vsg::Node>, vsg::dbox>>;
+
+    /// create the subgraph for key. When subtrees is assigned, the subgraphs for any keys it contains are taken from subtrees rather than created.
+    /// When archive is assigned CREATE_PAGEDLOD tiles are added to it rather than written to a file each.
+    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> subtile(vsgPoints::Settings& settings, vsgPoints::Levels::reverse_iterator level_itr, vsgPoints::Levels::reverse_iterator end_itr, vsgPoints::Key key, vsg::dbox& bound, bool root = false, const SubtreeNodes* subtrees = nullptr, TileArchiveWriter* archive = nullptr);
+
+    /// create a paged database from levels. Tiles are added to archive when assigned, otherwise if settings.archiveTiles is true to a newly opened
+    /// archive alongside settings.path. Returns a null node if the tiles couldn't all be added to the archive.
+    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> createPagedLOD(vsgPoints::Levels& levels, vsgPoints::Settings& settings, const SubtreeNodes* subtrees = nullptr, TileArchiveWriter* archive = nullptr);
+
+    /// create a paged database from the full resolution bricks one subtree of settings.subtreeLevels levels at a time. The levels of each subtree are
+    /// generated, its tiles written and its bricks released before moving on to the next, so the memory used by the generated levels is bounded by a
+    /// subtree rather than the dataset. The full resolution bricks of subtrees yet to be built are still held, other than any spilled to respect
+    /// settings.memoryBudget. With DECIMATE_STRIDE the tiles match those of createPagedLOD(), with the voxel decimations the bricks of the level above
+    /// the subtrees are decimated separately for each contributing subtree, ordering their points differently, so the coarser levels can differ.
+    /// The bricks are consumed, leaving them empty. When store is assigned the bricks of each subtree are added to it before they are released.
+    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> createPagedLODStreamed(vsgPoints::Bricks& bricks, vsgPoints::Settings& settings, vsgPoints::BrickStore* store = nullptr);
+
+    /// add the points of bricks to the CREATE_PAGEDLOD database at settings->path, which must have been created with settings->storeBricks.
+    /// Only the bricks the new points land in and their ancestors are regenerated, along with the tiles containing them, the rest of the database is reused.
+    /// If the new points extend beyond the extents of the database it is rebuilt in full from the stored and new points.
+    /// Returns the new root of the database, which replaces the one previously written to disk.
+    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<vsg::Node> appendToPagedLOD(vsg::ref_ptr<vsgPoints::Bricks> bricks, vsg::ref_ptr<vsgPoints::Settings> settings);
 
 } // namespace vsgPoints
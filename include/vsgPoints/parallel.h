@@ -0,0 +1,30 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/Settings.h>
+
+#include <functional>
+
+namespace vsgPoints
+{
+
+    /// number of threads that will be used to run tasks passed to parallel_for(), including the calling thread.
+    extern VSGPOINTS_DECLSPEC size_t concurrency(const Settings& settings);
+
+    /// call func(index) for each index in the range [0, count). If settings.operationThreads is assigned the calls are distributed across
+    /// its threads and the calling thread, returning once all have completed, otherwise the calls are made in order on the calling thread.
+    /// If any call throws, the remaining calls still run and the first exception is rethrown on the calling thread once they have completed.
+    extern VSGPOINTS_DECLSPEC void parallel_for(const Settings& settings, size_t count, const std::function<void(size_t index)>& func);
+
+} // namespace vsgPoints
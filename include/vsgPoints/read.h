@@ -0,0 +1,29 @@
+#pragma once
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsg/io/Options.h>
+#include <vsg/nodes/Node.h>
+
+#include <vsgPoints/Bricks.h>
+
+namespace vsgPoints
+{
+
+    /// read filenames concurrently across settings->operationThreads and merge their points, in filename order, into a single Bricks so that
+    /// overlapping files share one set of levels rather than each getting a hierarchy of its own. Each file is read with its own copy of settings
+    /// so the readers don't contend over settings->bound, with settings->memoryBudget shared between the concurrent reads.
+    /// Files that load as nodes rather than points, such as meshes, are appended to nodes when assigned, other files are skipped with a warning.
+    extern VSGPOINTS_DECLSPEC vsg::ref_ptr<Bricks> readBricks(const vsg::Paths& filenames, vsg::ref_ptr<Settings> settings, vsg::ref_ptr<const vsg::Options> options, std::vector<vsg::ref_ptr<vsg::Node>>* nodes = nullptr);
+
+} // namespace vsgPoints
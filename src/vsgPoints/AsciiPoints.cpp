@@ -12,18 +12,122 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsgPoints/AsciiPoints.h>
 #include <vsgPoints/Bricks.h>
+#include <vsgPoints/MappedFile.h>
+#include <vsgPoints/parallel.h>
 
+#include <vsg/io/Logger.h>
 #include <vsg/io/Path.h>
 #include <vsg/io/read_line.h>
 #include <vsg/io/stream.h>
 #include <vsg/nodes/MatrixTransform.h>
 
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 
 #include <iostream>
 
 using namespace vsgPoints;
 
+namespace
+{
+    const uint32_t maxValuesPerLine = 10;
+
+    // parse the number at the start of [ptr, end), returning the end of the number or nullptr if there isn't one
+    const char* parseNumber(const char* ptr, const char* end, double& value)
+    {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        // std::from_chars doesn't accept a leading +
+        if (ptr < end && *ptr == '+') ++ptr;
+
+        auto [next, ec] = std::from_chars(ptr, end, value);
+        return (ec == std::errc()) ? next : nullptr;
+#else
+        // floating point std::from_chars isn't available, so copy the number to a null terminated buffer so strtod can't read beyond end
+        char buffer[64];
+        size_t length = 0;
+        while (ptr + length < end && length < sizeof(buffer) - 1 && ptr[length] != 0 && std::strchr("+-.0123456789eE", ptr[length])) ++length;
+        std::memcpy(buffer, ptr, length);
+        buffer[length] = 0;
+
+        char* bufferEnd = nullptr;
+        value = std::strtod(buffer, &bufferEnd);
+        return (bufferEnd == buffer) ? nullptr : ptr + (bufferEnd - buffer);
+#endif
+    }
+
+    // parse up to maxValuesPerLine numbers separated by white space, commas or semicolons, stopping at the first non numeric entry.
+    uint32_t parseLine(const char* ptr, const char* end, double* values)
+    {
+        uint32_t numValuesRead = 0;
+        while (numValuesRead < maxValuesPerLine)
+        {
+            while (ptr < end && (*ptr == ' ' || *ptr == '\t' || *ptr == ',' || *ptr == ';' || *ptr == '\r')) ++ptr;
+            if (ptr == end) break;
+
+            auto next = parseNumber(ptr, end, values[numValuesRead]);
+            if (!next) break;
+
+            ptr = next;
+            ++numValuesRead;
+        }
+        return numValuesRead;
+    }
+
+    // parse the lines between ptr and end, passing the points on to func in blocks
+    template<typename F>
+    void forEachBlock(const char* ptr, const char* end, F func)
+    {
+        const size_t blockSize = 1024;
+        vsg::dvec3 vertices[blockSize];
+        vsg::ubvec4 colors[blockSize];
+        size_t count = 0;
+
+        double values[maxValuesPerLine];
+        uint8_t alpha = 255;
+
+        while (ptr < end)
+        {
+            // memchr is typically vectorized so is used to find the line endings rather than scanning character by character
+            auto eol = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+            if (!eol) eol = end;
+
+            if (parseLine(ptr, eol, values) >= 6)
+            {
+                vertices[count].set(values[0], values[1], values[2]);
+                colors[count].set(static_cast<uint8_t>(values[3]), static_cast<uint8_t>(values[4]), static_cast<uint8_t>(values[5]), alpha);
+                if (++count == blockSize)
+                {
+                    func(vertices, colors, count);
+                    count = 0;
+                }
+            }
+
+            ptr = eol + 1;
+        }
+
+        if (count > 0) func(vertices, colors, count);
+    }
+
+    void parseLines(const char* ptr, const char* end, Bricks& bricks)
+    {
+        forEachBlock(ptr, end, [&](const vsg::dvec3* vertices, const vsg::ubvec4* colors, size_t count) { bricks.add(vertices, colors, count); });
+    }
+
+    // return the start of the first line beginning at or after position
+    size_t lineStart(const MappedFile& mappedFile, size_t position)
+    {
+        if (position == 0 || position >= mappedFile.size()) return std::min(position, mappedFile.size());
+
+        auto start = mappedFile.data() + position - 1;
+        auto eol = static_cast<const uint8_t*>(std::memchr(start, '\n', mappedFile.end() - start));
+        return eol ? static_cast<size_t>(eol + 1 - mappedFile.data()) : mappedFile.size();
+    }
+} // namespace
+
 AsciiPoints::AsciiPoints() :
     supportedExtensions{".3dc", ".asc"}
 {
@@ -48,17 +152,71 @@ vsg::ref_ptr<vsg::Object> AsciiPoints::read(const vsg::Path& filename, vsg::ref_
 
     auto bricks = vsgPoints::Bricks::create(settings);
 
-    auto values = vsg::doubleArray::create(10);
-    uint8_t alpha = 255;
+    vsg::ref_ptr<MappedFile> mappedFile;
+    if (settings->memoryMapFiles) mappedFile = MappedFile::create(filenameToUse);
 
-    std::ifstream fin(filenameToUse);
-    while (fin)
+    if (mappedFile && mappedFile->valid())
     {
-        if (auto numValuesRead = vsg::read_line(fin, values->data(), values->size()))
+        auto before_parse = std::chrono::steady_clock::now();
+
+        // split the file into newline aligned chunks that are parsed into per chunk Bricks on the worker threads,
+        // then merged in order so that the result matches parsing the whole file serially.
+        size_t numThreads = concurrency(*settings);
+        size_t minChunkSize = 1024 * 1024;
+        size_t numChunks = (numThreads > 1) ? std::max(size_t(1), std::min(numThreads * 4, mappedFile->size() / minChunkSize)) : 1;
+
+        auto text = reinterpret_cast<const char*>(mappedFile->data());
+        if (settings->twoPassRead)
+        {
+            bricks->addTwoPass(numChunks, [&](size_t i, const Bricks::BlockFunction& block) {
+                size_t start = lineStart(*mappedFile, (mappedFile->size() * i) / numChunks);
+                size_t end = lineStart(*mappedFile, (mappedFile->size() * (i + 1)) / numChunks);
+                forEachBlock(text + start, text + end, block);
+            });
+        }
+        else if (numChunks > 1)
+        {
+            std::vector<vsg::ref_ptr<Bricks>> chunkBricks(numChunks);
+            parallel_for(*settings, numChunks, [&](size_t i) {
+                size_t start = lineStart(*mappedFile, (mappedFile->size() * i) / numChunks);
+                size_t end = lineStart(*mappedFile, (mappedFile->size() * (i + 1)) / numChunks);
+
+                chunkBricks[i] = bricks->createEmpty();
+                parseLines(text + start, text + end, *chunkBricks[i]);
+            });
+
+            for (auto& chunk : chunkBricks)
+            {
+                if (!bricks->merge(*chunk))
+                {
+                    vsg::warn("AsciiPoints::read(", filename, ") unable to restore spilled points.");
+                    return {};
+                }
+            }
+        }
+        else
+        {
+            parseLines(text, text + mappedFile->size(), *bricks);
+        }
+
+        double time_to_parse = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::steady_clock::now() - before_parse).count();
+        double megabytes = static_cast<double>(mappedFile->size()) / (1024.0 * 1024.0);
+        vsg::info("AsciiPoints::read(", filename, ") parsed ", megabytes, " MB in ", time_to_parse, " seconds, ", (time_to_parse > 0.0 ? megabytes / time_to_parse : 0.0), " MB/s");
+    }
+    else
+    {
+        auto values = vsg::doubleArray::create(maxValuesPerLine);
+        uint8_t alpha = 255;
+
+        std::ifstream fin(filenameToUse);
+        while (fin)
         {
-            if (numValuesRead >= 6)
+            if (auto numValuesRead = vsg::read_line(fin, values->data(), values->size()))
             {
-                bricks->add(vsg::dvec3(values->at(0), values->at(1), values->at(2)), vsg::ubvec4(values->at(3), values->at(4), values->at(5), alpha));
+                if (numValuesRead >= 6)
+                {
+                    bricks->add(vsg::dvec3(values->at(0), values->at(1), values->at(2)), vsg::ubvec4(values->at(3), values->at(4), values->at(5), alpha));
+                }
             }
         }
     }
@@ -12,11 +12,15 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <vsgPoints/BIN.h>
 #include <vsgPoints/Bricks.h>
+#include <vsgPoints/MappedFile.h>
+#include <vsgPoints/parallel.h>
 
+#include <vsg/io/Logger.h>
 #include <vsg/io/Path.h>
 #include <vsg/io/stream.h>
 #include <vsg/nodes/MatrixTransform.h>
 
+#include <algorithm>
 #include <fstream>
 
 #include <iostream>
@@ -33,6 +37,35 @@ struct VsgIOPoint
 
 #pragma pack()
 
+namespace
+{
+    // convert the records to blocks small enough to stay in cache and pass them on to func
+    template<typename F>
+    void forEachBlock(const VsgIOPoint* begin, const VsgIOPoint* end, F func)
+    {
+        const size_t blockSize = 1024;
+        vsg::dvec3 vertices[blockSize];
+        vsg::ubvec4 colors[blockSize];
+        uint8_t alpha = 255;
+
+        while (begin != end)
+        {
+            size_t count = std::min(blockSize, static_cast<size_t>(end - begin));
+            for (size_t i = 0; i < count; ++i, ++begin)
+            {
+                vertices[i] = begin->v;
+                colors[i].set(begin->c.r, begin->c.g, begin->c.b, alpha);
+            }
+            func(vertices, colors, count);
+        }
+    }
+
+    void addRecords(Bricks& bricks, const VsgIOPoint* begin, const VsgIOPoint* end)
+    {
+        forEachBlock(begin, end, [&](const vsg::dvec3* vertices, const vsg::ubvec4* colors, size_t count) { bricks.add(vertices, colors, count); });
+    }
+} // namespace
+
 BIN::BIN() :
     supportedExtensions{".bin"}
 {
@@ -55,26 +88,71 @@ vsg::ref_ptr<vsg::Object> BIN::read(const vsg::Path& filename, vsg::ref_ptr<cons
         return {};
     }
 
-    auto bricks = Bricks::create(settings);
+    if (settings->numPointsPerBlock == 0)
+    {
+        vsg::warn("BIN::read(", filename, ") numPointsPerBlock must be greater than 0.");
+        return {};
+    }
 
-    std::ifstream fin(found_filename, std::ios::in | std::ios::binary);
-    if (!fin) return {};
+    auto bricks = Bricks::create(settings);
 
-    auto points = vsg::Array<VsgIOPoint>::create(settings->numPointsPerBlock);
-    uint8_t alpha = 255;
+    vsg::ref_ptr<MappedFile> mappedFile;
+    if (settings->memoryMapFiles) mappedFile = MappedFile::create(found_filename);
 
-    while (fin)
+    if (mappedFile && mappedFile->valid())
     {
-        size_t bytesToRead = settings->numPointsPerBlock * sizeof(VsgIOPoint);
-        fin.read(reinterpret_cast<char*>(points->dataPointer()), bytesToRead);
+        // walk the packed VsgIOPoint records in place rather than reading them into an intermediate buffer
+        auto records = reinterpret_cast<const VsgIOPoint*>(mappedFile->data());
+        size_t numPoints = mappedFile->size() / sizeof(VsgIOPoint);
+
+        // split the records into ranges that are quantized into per range Bricks on the worker threads,
+        // then merged in order so that the result matches reading the whole file serially.
+        size_t numThreads = concurrency(*settings);
+        size_t numRanges = (numThreads > 1) ? std::min(numThreads * 4, (numPoints + settings->numPointsPerBlock - 1) / settings->numPointsPerBlock) : 1;
+        if (settings->twoPassRead)
+        {
+            bricks->addTwoPass(numRanges, [&](size_t i, const Bricks::BlockFunction& block) {
+                forEachBlock(records + (numPoints * i) / numRanges, records + (numPoints * (i + 1)) / numRanges, block);
+            });
+        }
+        else if (numRanges > 1)
+        {
+            std::vector<vsg::ref_ptr<Bricks>> rangeBricks(numRanges);
+            parallel_for(*settings, numRanges, [&](size_t i) {
+                rangeBricks[i] = bricks->createEmpty();
+                addRecords(*rangeBricks[i], records + (numPoints * i) / numRanges, records + (numPoints * (i + 1)) / numRanges);
+            });
+
+            for (auto& range : rangeBricks)
+            {
+                if (!bricks->merge(*range))
+                {
+                    vsg::warn("BIN::read(", filename, ") unable to restore spilled points.");
+                    return {};
+                }
+            }
+        }
+        else
+        {
+            addRecords(*bricks, records, records + numPoints);
+        }
+    }
+    else
+    {
+        std::ifstream fin(found_filename, std::ios::in | std::ios::binary);
+        if (!fin) return {};
 
-        size_t numPointsRead = static_cast<size_t>(fin.gcount()) / sizeof(VsgIOPoint);
-        if (numPointsRead == 0) break;
+        auto points = vsg::Array<VsgIOPoint>::create(settings->numPointsPerBlock);
 
-        for (size_t i = 0; i < numPointsRead; ++i)
+        while (fin)
         {
-            auto& point = (*points)[i];
-            bricks->add(point.v, vsg::ubvec4(point.c.r, point.c.g, point.c.b, alpha));
+            size_t bytesToRead = settings->numPointsPerBlock * sizeof(VsgIOPoint);
+            fin.read(reinterpret_cast<char*>(points->dataPointer()), bytesToRead);
+
+            size_t numPointsRead = static_cast<size_t>(fin.gcount()) / sizeof(VsgIOPoint);
+            if (numPointsRead == 0) break;
+
+            addRecords(*bricks, points->data(), points->data() + numPointsRead);
         }
     }
 
@@ -13,8 +13,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsgPoints/Brick.h>
 #include <vsgPoints/BrickShaderSet.h>
 
+#include <vsg/commands/BindVertexBuffers.h>
+#include <vsg/commands/Commands.h>
+#include <vsg/commands/Draw.h>
+#include <vsg/commands/DrawIndirect.h>
 #include <vsg/io/Logger.h>
+#include <vsg/io/Options.h>
 #include <vsg/io/write.h>
+#include <vsg/nodes/CullNode.h>
 #include <vsg/nodes/LOD.h>
 #include <vsg/nodes/PagedLOD.h>
 #include <vsg/nodes/StateGroup.h>
@@ -22,7 +28,14 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/state/ViewDependentState.h>
 #include <vsg/state/material.h>
 #include <vsg/utils/GraphicsPipelineConfigurator.h>
+#include <vsg/utils/SharedObjects.h>
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 
 using namespace vsgPoints;
@@ -31,98 +44,518 @@ using namespace vsgPoints;
 //
 // Brick
 //
-Brick::Brick()
+Brick::Brick(uint32_t in_bits) :
+    bits(in_bits)
 {
 }
 
 Brick::~Brick()
 {
+    if (_numSpilled > 0) std::remove(spillFilename.string().c_str());
 }
 
-vsg::ref_ptr<vsg::Node> Brick::createRendering(const Settings& settings, const vsg::vec4& positionScale, const vsg::vec2& pointSize)
+namespace
 {
-    vsg::ref_ptr<vsg::Data> vertices;
+    size_t vertexSize(uint32_t bits)
+    {
+        return (bits == 8) ? sizeof(vsg::ubvec3) : ((bits == 10) ? sizeof(uint32_t) : sizeof(vsg::usvec3));
+    }
 
-    auto normals = vsg::vec3Value::create(vsg::vec3(0.0f, 0.0f, 1.0f));
-    auto colors = vsg::ubvec4Array::create(points.size(), vsg::Data::Properties(VK_FORMAT_R8G8B8A8_UNORM));
-    auto positionScaleValue = vsg::vec4Value::create(positionScale);
-    auto pointSizeValue = vsg::vec2Value::create(pointSize);
+    // replace object with an identical one already held by the settings.options->sharedObjects, if any, so bricks don't each hold their own copy
+    template<class T>
+    vsg::ref_ptr<T> share(const Settings& settings, vsg::ref_ptr<T> object)
+    {
+        if (settings.options && settings.options->sharedObjects) settings.options->sharedObjects->share(object);
+        return object;
+    }
+} // namespace
 
-    normals->properties.format = VK_FORMAT_R32G32B32_SFLOAT;
-    positionScaleValue->properties.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    pointSizeValue->properties.format = VK_FORMAT_R32G32_SFLOAT;
+void Brick::_allocate(size_t numPoints)
+{
+    vsg::ref_ptr<vsg::Data> new_vertices;
+    if (bits == 8)
+    {
+        new_vertices = vsg::ubvec3Array::create(numPoints, vsg::Data::Properties(VK_FORMAT_R8G8B8_UNORM));
+    }
+    else if (bits == 10)
+    {
+        new_vertices = vsg::uintArray::create(numPoints, vsg::Data::Properties(VK_FORMAT_A2R10G10B10_UNORM_PACK32));
+    }
+    else
+    {
+        new_vertices = vsg::usvec3Array::create(numPoints, vsg::Data::Properties(VK_FORMAT_R16G16B16_UNORM));
+    }
+    auto new_colors = vsg::ubvec4Array::create(numPoints, vsg::Data::Properties(VK_FORMAT_R8G8B8A8_UNORM));
 
-    if (settings.bits == 8)
+    if (_size > 0)
     {
-        auto vertices_8bit = vsg::ubvec3Array::create(points.size(), vsg::Data::Properties(VK_FORMAT_R8G8B8_UNORM));
-        auto vertex_itr = vertices_8bit->begin();
-        auto color_itr = colors->begin();
-        for (auto& point : points)
-        {
-            (vertex_itr++)->set(static_cast<uint8_t>(point.v.x), static_cast<uint8_t>(point.v.y), static_cast<uint8_t>(point.v.z));
-            *(color_itr++) = point.c;
-        }
+        std::memcpy(new_vertices->dataPointer(), vertices->dataPointer(), _size * new_vertices->valueSize());
+        std::memcpy(new_colors->dataPointer(), colors->dataPointer(), _size * sizeof(vsg::ubvec4));
+    }
+
+    vertices = new_vertices;
+    colors = new_colors;
+    _vertexData = vertices->dataPointer();
+}
 
-        vertices = vertices_8bit;
+void Brick::reserve(size_t numPoints)
+{
+    if (numPoints > capacity()) _allocate(numPoints);
+}
+
+void Brick::resize(size_t numPoints)
+{
+    reserve(numPoints);
+    _size = numPoints;
+}
+
+void Brick::trim()
+{
+    if (_size == capacity()) return;
+
+    if (_size == 0)
+    {
+        vertices = {};
+        colors = {};
+        _vertexData = nullptr;
     }
-    else if (settings.bits == 10)
+    else
     {
-        auto vertices_10bit = vsg::uintArray::create(points.size(), vsg::Data::Properties(VK_FORMAT_A2R10G10B10_UNORM_PACK32));
-        auto vertex_itr = vertices_10bit->begin();
-        auto color_itr = colors->begin();
-        for (auto& point : points)
+        _allocate(_size);
+    }
+}
+
+void Brick::append(const Brick& rhs)
+{
+    if (rhs.empty()) return;
+
+    reserve(_size + rhs._size);
+    if (rhs.bits == bits)
+    {
+        std::memcpy(static_cast<uint8_t*>(_vertexData) + _size * vertices->valueSize(), rhs._vertexData, rhs._size * vertices->valueSize());
+        std::memcpy(colors->data() + _size, rhs.colors->data(), rhs._size * sizeof(vsg::ubvec4));
+        _size += rhs._size;
+
+        _minVertex.set(std::min(_minVertex.x, rhs._minVertex.x), std::min(_minVertex.y, rhs._minVertex.y), std::min(_minVertex.z, rhs._minVertex.z));
+        _maxVertex.set(std::max(_maxVertex.x, rhs._maxVertex.x), std::max(_maxVertex.y, rhs._maxVertex.y), std::max(_maxVertex.z, rhs._maxVertex.z));
+    }
+    else
+    {
+        for (size_t i = 0; i < rhs._size; ++i) add(rhs.point(i));
+    }
+}
+
+size_t Brick::memoryUsed() const
+{
+    return capacity() * (vertexSize(bits) + sizeof(vsg::ubvec4));
+}
+
+size_t Brick::spill()
+{
+    if (_size > 0)
+    {
+        // spilled points are stored as records of the vertex followed by its color
+        size_t vs = vertexSize(bits);
+        size_t recordSize = vs + sizeof(vsg::ubvec4);
+
+        // truncate any file left behind with the same name on the first spill, then append to it
+        std::ofstream fout(spillFilename, std::ios::out | std::ios::binary | (_numSpilled == 0 ? std::ios::trunc : std::ios::app));
+        if (!fout)
         {
-            *(vertex_itr++) = 3 << 30 | (static_cast<uint32_t>(point.v.x) << 20) | (static_cast<uint32_t>(point.v.y) << 10) | (static_cast<uint32_t>(point.v.z));
-            *(color_itr++) = point.c;
+            vsg::warn("Brick::spill() unable to open ", spillFilename);
+            return 0;
         }
 
-        vertices = vertices_10bit;
+        const size_t blockSize = 4096;
+        std::vector<uint8_t> buffer(blockSize * recordSize);
+        auto vertexData = static_cast<const uint8_t*>(_vertexData);
+
+        for (size_t base = 0; base < _size; base += blockSize)
+        {
+            size_t n = std::min(blockSize, _size - base);
+            for (size_t i = 0; i < n; ++i)
+            {
+                std::memcpy(buffer.data() + i * recordSize, vertexData + (base + i) * vs, vs);
+                std::memcpy(buffer.data() + i * recordSize + vs, &((*colors)[base + i]), sizeof(vsg::ubvec4));
+            }
+            fout.write(reinterpret_cast<const char*>(buffer.data()), n * recordSize);
+        }
+
+        if (!fout)
+        {
+            vsg::warn("Brick::spill() failed writing to ", spillFilename);
+
+            // discard the partially written points so the file holds just those previously spilled, which remain valid, and keep these in memory
+            fout.close();
+            std::error_code ec;
+            std::filesystem::resize_file(spillFilename.string(), _numSpilled * recordSize, ec);
+            return 0;
+        }
+
+        _numSpilled += _size;
+    }
+
+    size_t released = memoryUsed();
+
+    vertices = {};
+    colors = {};
+    _vertexData = nullptr;
+    _size = 0;
+
+    return released;
+}
+
+bool Brick::restore()
+{
+    if (_numSpilled == 0) return true;
+
+    std::ifstream fin(spillFilename, std::ios::in | std::ios::binary);
+    if (!fin)
+    {
+        vsg::warn("Brick::restore() unable to open ", spillFilename);
+        return false;
     }
-    else if (settings.bits == 16)
+
+    // the spilled points were added before those held in memory so are placed ahead of them
+    auto original_vertices = vertices;
+    auto original_colors = colors;
+    size_t numInMemory = _size;
+
+    _size = 0;
+    _allocate(_numSpilled + numInMemory);
+
+    size_t vs = vertexSize(bits);
+    size_t recordSize = vs + sizeof(vsg::ubvec4);
+    const size_t blockSize = 4096;
+    std::vector<uint8_t> buffer(blockSize * recordSize);
+    auto vertexData = static_cast<uint8_t*>(_vertexData);
+
+    for (size_t base = 0; base < _numSpilled; base += blockSize)
     {
-        auto vertices_16bit = vsg::usvec3Array::create(points.size(), vsg::Data::Properties(VK_FORMAT_R16G16B16_UNORM));
-        auto vertex_itr = vertices_16bit->begin();
-        auto color_itr = colors->begin();
-        for (auto& point : points)
+        size_t n = std::min(blockSize, _numSpilled - base);
+        fin.read(reinterpret_cast<char*>(buffer.data()), n * recordSize);
+        if (static_cast<size_t>(fin.gcount()) != n * recordSize)
         {
-            (vertex_itr++)->set(static_cast<uint16_t>(point.v.x), static_cast<uint16_t>(point.v.y), static_cast<uint16_t>(point.v.z));
-            *(color_itr++) = point.c;
+            vsg::warn("Brick::restore() failed reading from ", spillFilename);
+            vertices = original_vertices;
+            colors = original_colors;
+            _vertexData = vertices ? vertices->dataPointer() : nullptr;
+            _size = numInMemory;
+            return false;
         }
 
-        vertices = vertices_16bit;
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::memcpy(vertexData + (base + i) * vs, buffer.data() + i * recordSize, vs);
+            std::memcpy(&((*colors)[base + i]), buffer.data() + i * recordSize + vs, sizeof(vsg::ubvec4));
+        }
     }
-    else
+
+    if (numInMemory > 0)
     {
-        return {};
+        std::memcpy(vertexData + _numSpilled * vs, original_vertices->dataPointer(), numInMemory * vs);
+        std::memcpy(colors->data() + _numSpilled, original_colors->data(), numInMemory * sizeof(vsg::ubvec4));
     }
 
+    fin.close();
+    std::remove(spillFilename.string().c_str());
+
+    _size = _numSpilled + numInMemory;
+    _numSpilled = 0;
+
+    return true;
+}
+
+void Brick::clear()
+{
+    if (_numSpilled > 0) std::remove(spillFilename.string().c_str());
+
+    vertices = {};
+    colors = {};
+    _vertexData = nullptr;
+    _size = 0;
+    _numSpilled = 0;
+    _minVertex.set(0xffff, 0xffff, 0xffff);
+    _maxVertex.set(0, 0, 0);
+}
+
+void Brick::computeVertexBound()
+{
+    _minVertex.set(0xffff, 0xffff, 0xffff);
+    _maxVertex.set(0, 0, 0);
+    expandVertexBound(0, _size);
+}
+
+void Brick::expandVertexBound(size_t first, size_t count)
+{
+    for (size_t i = first; i < first + count; ++i)
+    {
+        auto v = vertex(i);
+        _minVertex.set(std::min(_minVertex.x, v.x), std::min(_minVertex.y, v.y), std::min(_minVertex.z, v.z));
+        _maxVertex.set(std::max(_maxVertex.x, v.x), std::max(_maxVertex.y, v.y), std::max(_maxVertex.z, v.z));
+    }
+}
+
+void Brick::reorder(const std::vector<uint32_t>& order)
+{
+    // gather into new arrays so any draws already sharing the current arrays are unaffected
+    auto original_vertices = vertices;
+    auto original_colors = colors;
+    auto original_vertexData = static_cast<const uint8_t*>(original_vertices->dataPointer());
+
+    _size = 0;
+    _allocate(order.size());
+
+    size_t vertexSize = vertices->valueSize();
+    auto new_vertexData = static_cast<uint8_t*>(_vertexData);
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        std::memcpy(new_vertexData + i * vertexSize, original_vertexData + order[i] * vertexSize, vertexSize);
+        (*colors)[i] = (*original_colors)[order[i]];
+    }
+    _size = order.size();
+}
+
+vsg::dbox Brick::computeBound(const Settings& settings, Key key) const
+{
+    double brickPrecision = settings.precision * static_cast<double>(key.w);
+    double brickSize = brickPrecision * pow(2.0, static_cast<double>(bits));
+
+    vsg::dvec3 position(static_cast<double>(key.x) * brickSize, static_cast<double>(key.y) * brickSize, static_cast<double>(key.z) * brickSize);
+    position -= settings.offset;
+
+    vsg::dbox bound;
+    if (_minVertex.x > _maxVertex.x) return bound;
+
+    bound.add(position.x + brickPrecision * static_cast<double>(_minVertex.x),
+              position.y + brickPrecision * static_cast<double>(_minVertex.y),
+              position.z + brickPrecision * static_cast<double>(_minVertex.z));
+    bound.add(position.x + brickPrecision * static_cast<double>(_maxVertex.x),
+              position.y + brickPrecision * static_cast<double>(_maxVertex.y),
+              position.z + brickPrecision * static_cast<double>(_maxVertex.z));
+    return bound;
+}
+
+vsg::ref_ptr<vsg::Node> Brick::createRendering(const Settings& settings, const vsg::vec4& positionScale, const vsg::vec2& pointSize)
+{
+    return createRendering(settings, 0, _size, positionScale, pointSize);
+}
+
+vsg::ref_ptr<vsg::Node> Brick::createRendering(const Settings& settings, size_t first, size_t count, const vsg::vec4& positionScale, const vsg::vec2& pointSize)
+{
+    // the vertex and color arrays are already in the GPU format so are shared directly, just drop any unused capacity first
+    trim();
+    if (!vertices || first + count > _size) return {};
+
+    auto normals = vsg::vec3Value::create(vsg::vec3(0.0f, 0.0f, 1.0f));
+    auto positionScaleValue = vsg::vec4Value::create(positionScale);
+    auto pointSizeValue = vsg::vec2Value::create(pointSize);
+
+    normals->properties.format = VK_FORMAT_R32G32B32_SFLOAT;
+    positionScaleValue->properties.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    pointSizeValue->properties.format = VK_FORMAT_R32G32_SFLOAT;
+
+    // the normal is the same for all bricks and the point size for all bricks of a level, the position is unique to each brick so isn't worth sharing
+    normals = share(settings, normals);
+    pointSizeValue = share(settings, pointSizeValue);
+
     // set up vertexDraw that will do the rendering.
     auto vertexDraw = vsg::VertexDraw::create();
     vertexDraw->assignArrays({vertices, normals, colors, positionScaleValue, pointSizeValue});
-    vertexDraw->vertexCount = points.size();
+    vertexDraw->firstVertex = static_cast<uint32_t>(first);
+    vertexDraw->vertexCount = static_cast<uint32_t>(count);
     vertexDraw->instanceCount = 1;
 
     return vertexDraw;
 }
 
+PackedBricks Brick::packBricks(const Settings& settings, const std::vector<std::pair<Key, vsg::ref_ptr<Brick>>>& bricks)
+{
+    PackedBricks result;
+
+    size_t numPoints = 0;
+    size_t numDraws = 0;
+    for (auto& [key, brick] : bricks)
+    {
+        if (!brick->restore()) return result;
+        numPoints += brick->size();
+        if (!brick->empty()) ++numDraws;
+    }
+    if (numPoints == 0) return result;
+
+    // the brick's points are appended into a single brick so its arrays hold them in the GPU format, with the instance rate arrays holding a value per draw
+    auto packed = Brick::create(settings.bits);
+    packed->reserve(numPoints);
+
+    result.normals = vsg::vec3Array::create(numDraws, vsg::vec3(0.0f, 0.0f, 1.0f), vsg::Data::Properties(VK_FORMAT_R32G32B32_SFLOAT));
+    result.positionScales = vsg::vec4Array::create(numDraws, vsg::Data::Properties(VK_FORMAT_R32G32B32A32_SFLOAT));
+    result.pointSizes = vsg::vec2Array::create(numDraws, vsg::Data::Properties(VK_FORMAT_R32G32_SFLOAT));
+    result.drawCommands = vsg::DrawIndirectCommandArray::create(numDraws);
+
+    uint32_t instance = 0;
+    for (auto& [key, brick] : bricks)
+    {
+        if (brick->empty()) continue;
+
+        double brickPrecision = settings.precision * static_cast<double>(key.w);
+        double brickSize = brickPrecision * pow(2.0, static_cast<double>(settings.bits));
+
+        vsg::dvec3 position(static_cast<double>(key.x) * brickSize, static_cast<double>(key.y) * brickSize, static_cast<double>(key.z) * brickSize);
+        position -= settings.offset;
+
+        result.positionScales->set(instance, vsg::vec4(position.x, position.y, position.z, brickSize));
+        result.pointSizes->set(instance, vsg::vec2(brickPrecision * settings.pointSize, brickPrecision));
+        result.drawCommands->set(instance, vsg::DrawIndirectCommand{static_cast<uint32_t>(brick->size()), 1, static_cast<uint32_t>(packed->size()), instance});
+        ++instance;
+
+        packed->append(*brick);
+        result.bound.add(brick->computeBound(settings, key));
+    }
+
+    result.vertices = packed->vertices;
+    result.colors = packed->colors;
+    return result;
+}
+
+vsg::ref_ptr<vsg::Node> Brick::createPackedRendering(const Settings& settings, const std::vector<std::pair<Key, vsg::ref_ptr<Brick>>>& bricks, vsg::dbox& bound)
+{
+    auto packed = packBricks(settings, bricks);
+    if (!packed.vertices) return {};
+
+    bound.add(packed.bound);
+
+    auto commands = vsg::Commands::create();
+    commands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{packed.vertices, share(settings, packed.normals), packed.colors, packed.positionScales, packed.pointSizes}));
+
+    if (settings.drawIndirect)
+    {
+        commands->addChild(vsg::DrawIndirect::create(packed.drawCommands, static_cast<uint32_t>(packed.drawCommands->size()), static_cast<uint32_t>(sizeof(vsg::DrawIndirectCommand))));
+    }
+    else
+    {
+        for (auto& dc : *packed.drawCommands)
+        {
+            commands->addChild(vsg::Draw::create(dc.vertexCount, dc.instanceCount, dc.firstVertex, dc.firstInstance));
+        }
+    }
+
+    return commands;
+}
+
+namespace
+{
+    struct SubdividedRange
+    {
+        size_t first;
+        size_t count;
+        vsg::usvec3 min;
+        vsg::usvec3 max;
+    };
+
+    using OrderIterator = std::vector<uint32_t>::iterator;
+
+    // partition the [first, last) range of order into the octants of the cell at origin until each holds no more than maxPoints points,
+    // appending the resulting ranges, along with their bounds in quantized units, to ranges.
+    void subdivide(const std::vector<vsg::usvec3>& decoded, std::vector<uint32_t>& order, OrderIterator first, OrderIterator last, vsg::usvec3 origin, uint32_t cellSize, size_t maxPoints, std::vector<SubdividedRange>& ranges)
+    {
+        if (static_cast<size_t>(last - first) <= maxPoints || cellSize <= 1)
+        {
+            SubdividedRange range{static_cast<size_t>(first - order.begin()), static_cast<size_t>(last - first), vsg::usvec3(0xffff, 0xffff, 0xffff), vsg::usvec3(0, 0, 0)};
+            for (auto itr = first; itr != last; ++itr)
+            {
+                auto& v = decoded[*itr];
+                range.min.set(std::min(range.min.x, v.x), std::min(range.min.y, v.y), std::min(range.min.z, v.z));
+                range.max.set(std::max(range.max.x, v.x), std::max(range.max.y, v.y), std::max(range.max.z, v.z));
+            }
+            ranges.push_back(range);
+            return;
+        }
+
+        uint32_t half = cellSize / 2;
+        vsg::usvec3 mid(static_cast<uint16_t>(origin.x + half), static_cast<uint16_t>(origin.y + half), static_cast<uint16_t>(origin.z + half));
+
+        auto split_x = std::partition(first, last, [&](uint32_t i) { return decoded[i].x < mid.x; });
+        std::array<OrderIterator, 3> x_ranges{first, split_x, last};
+        for (size_t xi = 0; xi < 2; ++xi)
+        {
+            auto split_y = std::partition(x_ranges[xi], x_ranges[xi + 1], [&](uint32_t i) { return decoded[i].y < mid.y; });
+            std::array<OrderIterator, 3> y_ranges{x_ranges[xi], split_y, x_ranges[xi + 1]};
+            for (size_t yi = 0; yi < 2; ++yi)
+            {
+                auto split_z = std::partition(y_ranges[yi], y_ranges[yi + 1], [&](uint32_t i) { return decoded[i].z < mid.z; });
+                std::array<OrderIterator, 3> z_ranges{y_ranges[yi], split_z, y_ranges[yi + 1]};
+                for (size_t zi = 0; zi < 2; ++zi)
+                {
+                    if (z_ranges[zi] == z_ranges[zi + 1]) continue;
+
+                    vsg::usvec3 child_origin(static_cast<uint16_t>(xi ? mid.x : origin.x), static_cast<uint16_t>(yi ? mid.y : origin.y), static_cast<uint16_t>(zi ? mid.z : origin.z));
+                    subdivide(decoded, order, z_ranges[zi], z_ranges[zi + 1], child_origin, half, maxPoints, ranges);
+                }
+            }
+        }
+    }
+} // namespace
+
 vsg::ref_ptr<vsg::Node> Brick::createRendering(const Settings& settings, Key key, vsg::dbox& bound)
 {
+    if (!restore()) return {};
+
+    // additive hierarchies can leave bricks with all their points moved up into their parent
+    if (empty()) return {};
+
     double brickPrecision = settings.precision * static_cast<double>(key.w);
-    double brickSize = brickPrecision * pow(2.0, static_cast<double>(settings.bits));
+    double brickSize = brickPrecision * pow(2.0, static_cast<double>(bits));
 
     vsg::dvec3 position(static_cast<double>(key.x) * brickSize, static_cast<double>(key.y) * brickSize, static_cast<double>(key.z) * brickSize);
     position -= settings.offset;
 
-    for (auto& point : points)
+    vsg::vec2 pointSize(brickPrecision * settings.pointSize, brickPrecision);
+    vsg::vec4 positionScale(position.x, position.y, position.z, brickSize);
+
+    auto addToBound = [&](const vsg::usvec3& v, vsg::dbox& local_bound) {
+        local_bound.add(position.x + brickPrecision * static_cast<double>(v.x),
+                        position.y + brickPrecision * static_cast<double>(v.y),
+                        position.z + brickPrecision * static_cast<double>(v.z));
+    };
+
+    if (!settings.subdivideBricks || _size <= settings.numPointsPerBlock)
     {
-        auto& v = point.v;
-        bound.add(position.x + brickPrecision * static_cast<double>(v.x),
-                  position.y + brickPrecision * static_cast<double>(v.y),
-                  position.z + brickPrecision * static_cast<double>(v.z));
+        bound.add(computeBound(settings, key));
+        return createRendering(settings, positionScale, pointSize);
     }
 
-    vsg::vec2 pointSize(brickPrecision * settings.pointSize, brickPrecision);
-    vsg::vec4 positionScale(position.x, position.y, position.z, brickSize);
+    // recursively partition the points into octants of the brick until each holds no more than numPointsPerBlock points, then reorder
+    // the brick so each octant's points are contiguous and create a culled draw for each range of the shared arrays. The brick's key
+    // and place in the hierarchy are unchanged, so this caps the points per draw rather than refining the brick into finer keys.
+    std::vector<vsg::usvec3> decoded(_size);
+    for (size_t i = 0; i < _size; ++i) decoded[i] = vertex(i);
+
+    std::vector<uint32_t> order(_size);
+    for (size_t i = 0; i < _size; ++i) order[i] = static_cast<uint32_t>(i);
+
+    std::vector<SubdividedRange> ranges;
+    subdivide(decoded, order, order.begin(), order.end(), vsg::usvec3(0, 0, 0), 1u << bits, settings.numPointsPerBlock, ranges);
+
+    reorder(order);
+
+    // the points are drawn as sprites of around pointSize.x across, so pad each cull bound by half that to avoid culling sprites overlapping the view frustum
+    double spriteRadius = static_cast<double>(pointSize.x) * 0.5;
+
+    auto group = vsg::Group::create();
+    for (auto& range : ranges)
+    {
+        // convert just the corners of the range's bound from quantized units
+        vsg::dbox range_bound;
+        addToBound(range.min, range_bound);
+        addToBound(range.max, range_bound);
+        bound.add(range_bound);
+
+        auto cullNode = vsg::CullNode::create();
+        cullNode->bound.center = (range_bound.min + range_bound.max) * 0.5;
+        cullNode->bound.radius = vsg::length(range_bound.max - range_bound.min) * 0.5 + spriteRadius;
+        cullNode->child = createRendering(settings, range.first, range.count, positionScale, pointSize);
+        group->addChild(cullNode);
+    }
 
-    return createRendering(settings, positionScale, pointSize);
+    return group;
 }
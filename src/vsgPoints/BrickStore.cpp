@@ -0,0 +1,322 @@
+
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/BrickStore.h>
+
+#include <vsg/io/FileSystem.h>
+#include <vsg/io/Logger.h>
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+using namespace vsgPoints;
+
+namespace
+{
+    const char storeMagic[8] = {'v', 's', 'g', 'P', 'B', 'S', 'T', 'R'};
+    const uint32_t storeVersion = 2;
+
+    template<typename T>
+    void writeValue(std::ostream& out, const T& value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool readValue(std::istream& in, T& value)
+    {
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return static_cast<size_t>(in.gcount()) == sizeof(T);
+    }
+
+    // number of bytes left to read from in, used to validate counts before allocating for them
+    uint64_t remaining(std::istream& in)
+    {
+        auto position = in.tellg();
+        in.seekg(0, std::ios::end);
+        auto end = in.tellg();
+        in.seekg(position);
+        return (position >= 0 && end >= position) ? static_cast<uint64_t>(end - position) : 0;
+    }
+
+    size_t vertexSize(uint32_t bits)
+    {
+        return (bits == 8) ? sizeof(vsg::ubvec3) : ((bits == 10) ? sizeof(uint32_t) : sizeof(vsg::usvec3));
+    }
+} // namespace
+
+BrickStore::BrickStore(const vsg::Path& in_directory) :
+    directory(in_directory)
+{
+}
+
+void BrickStore::assign(const Settings& settings, const vsg::ivec3& in_keyOrigin)
+{
+    precision = settings.precision;
+    bits = settings.bits;
+    decimation = settings.decimation;
+    additive = settings.additive;
+    subdivideBricks = settings.subdivideBricks;
+    numPointsPerBlock = settings.numPointsPerBlock;
+    packThreshold = settings.packThreshold;
+    drawIndirect = settings.drawIndirect;
+    compressTiles = settings.compressTiles;
+    extension = settings.extension;
+    keyOrigin = in_keyOrigin;
+}
+
+bool BrickStore::compatible(const Settings& settings) const
+{
+    if (precision != settings.precision || bits != settings.bits || decimation != static_cast<uint32_t>(settings.decimation) || extension != settings.extension) return false;
+
+    // numPointsPerBlock only affects the tiles when subdividing bricks
+    if (additive != settings.additive || subdivideBricks != settings.subdivideBricks || (subdivideBricks && numPointsPerBlock != settings.numPointsPerBlock)) return false;
+
+    return packThreshold == settings.packThreshold && drawIndirect == settings.drawIndirect && compressTiles == settings.compressTiles;
+}
+
+Key BrickStore::rootKey() const
+{
+    Key root(0, 0, 0, 0);
+    for (auto& [key, entry] : entries)
+    {
+        if (key.w > root.w) root = key;
+    }
+    return root;
+}
+
+vsg::Path BrickStore::brickFilename(const Key& key) const
+{
+    return directory / vsg::make_string(key.w, "/", key.z, "/", key.y, "/", key.x, ".brick");
+}
+
+bool BrickStore::add(const Key& key, Brick& brick, const Settings& settings)
+{
+    // spilled bricks are read back for writing then spilled again
+    bool spilled = brick.numSpilled() > 0;
+    if (!brick.restore())
+    {
+        vsg::warn("BrickStore::add() unable to restore spilled points for ", brickFilename(key));
+        removeManifest();
+        return false;
+    }
+
+    auto filename = brickFilename(key);
+    vsg::makeDirectory(vsg::filePath(filename));
+
+    std::ofstream fout(filename, std::ios::out | std::ios::binary);
+    if (!fout)
+    {
+        vsg::warn("BrickStore::add() unable to open ", filename);
+        removeManifest();
+        return false;
+    }
+
+    writeValue(fout, brick.bits);
+    writeValue(fout, static_cast<uint64_t>(brick.size()));
+    if (!brick.empty())
+    {
+        fout.write(static_cast<const char*>(brick.vertices->dataPointer()), brick.size() * brick.vertices->valueSize());
+        fout.write(reinterpret_cast<const char*>(brick.colors->dataPointer()), brick.size() * sizeof(vsg::ubvec4));
+    }
+
+    // the subtree bound is the union of the children's bounds, or for bricks without children the bound of its own points
+    auto& entry = entries[key];
+    entry.numPoints = brick.size();
+    entry.bound = vsg::dbox();
+    if (key.w > 1)
+    {
+        for (int32_t i = 0; i < 8; ++i)
+        {
+            Key child(key.x * 2 + (i & 1), key.y * 2 + ((i >> 1) & 1), key.z * 2 + ((i >> 2) & 1), key.w / 2);
+            if (auto itr = entries.find(child); itr != entries.end()) entry.bound.add(itr->second.bound);
+        }
+    }
+    if (!entry.bound.valid()) entry.bound = brick.computeBound(settings, key);
+
+    if (spilled) brick.spill();
+
+    if (!fout.good())
+    {
+        vsg::warn("BrickStore::add() unable to write ", filename);
+        removeManifest();
+        return false;
+    }
+
+    return true;
+}
+
+bool BrickStore::add(const Levels& levels, const Settings& settings)
+{
+    bool result = true;
+    for (auto& level : levels)
+    {
+        for (auto& [key, brick] : level->sorted())
+        {
+            if (!add(key, *brick, settings)) result = false;
+        }
+    }
+    return result;
+}
+
+vsg::ref_ptr<Brick> BrickStore::read(const Key& key) const
+{
+    if (entries.find(key) == entries.end()) return {};
+
+    auto filename = brickFilename(key);
+    std::ifstream fin(filename, std::ios::in | std::ios::binary);
+
+    uint32_t brickBits = 0;
+    uint64_t numPoints = 0;
+    if (!fin || !readValue(fin, brickBits) || !readValue(fin, numPoints))
+    {
+        vsg::warn("BrickStore::read() unable to read ", filename);
+        return {};
+    }
+
+    if (brickBits != 8 && brickBits != 10 && brickBits != 16)
+    {
+        vsg::warn("BrickStore::read() unsupported bits ", brickBits, " in ", filename);
+        return {};
+    }
+
+    if (numPoints > remaining(fin) / (vertexSize(brickBits) + sizeof(vsg::ubvec4)))
+    {
+        vsg::warn("BrickStore::read() truncated brick ", filename);
+        return {};
+    }
+
+    auto brick = Brick::create(brickBits);
+    brick->resize(static_cast<size_t>(numPoints));
+    if (numPoints > 0)
+    {
+        fin.read(static_cast<char*>(brick->vertices->dataPointer()), numPoints * brick->vertices->valueSize());
+        fin.read(reinterpret_cast<char*>(brick->colors->dataPointer()), numPoints * sizeof(vsg::ubvec4));
+        if (!fin)
+        {
+            vsg::warn("BrickStore::read() truncated brick ", filename);
+            return {};
+        }
+
+        brick->computeVertexBound();
+    }
+
+    return brick;
+}
+
+bool BrickStore::readManifest()
+{
+    auto filename = directory / "manifest.vsgpbs";
+    std::ifstream fin(filename, std::ios::in | std::ios::binary);
+    if (!fin) return false;
+
+    char magic[8];
+    uint32_t version = 0;
+    fin.read(magic, sizeof(magic));
+    if (static_cast<size_t>(fin.gcount()) != sizeof(magic) || std::memcmp(magic, storeMagic, sizeof(magic)) != 0 || !readValue(fin, version) || version != storeVersion)
+    {
+        vsg::warn("BrickStore::readManifest() ", filename, " is not a supported brick store manifest.");
+        return false;
+    }
+
+    uint8_t additiveValue = 0, subdivideBricksValue = 0, drawIndirectValue = 0, compressTilesValue = 0;
+    if (!readValue(fin, precision) || !readValue(fin, bits) || !readValue(fin, decimation) || !readValue(fin, additiveValue) || !readValue(fin, subdivideBricksValue) ||
+        !readValue(fin, numPointsPerBlock) || !readValue(fin, packThreshold) || !readValue(fin, drawIndirectValue) || !readValue(fin, compressTilesValue)) return false;
+
+    additive = additiveValue != 0;
+    subdivideBricks = subdivideBricksValue != 0;
+    drawIndirect = drawIndirectValue != 0;
+    compressTiles = compressTilesValue != 0;
+
+    uint32_t length = 0;
+    if (!readValue(fin, keyOrigin) || !readValue(fin, length) || length > remaining(fin)) return false;
+
+    std::string extensionString(length, '\0');
+    fin.read(extensionString.data(), length);
+    extension = extensionString;
+
+    // each entry holds a key, point count and bound
+    uint64_t numEntries = 0;
+    if (!readValue(fin, numEntries) || numEntries > remaining(fin) / (sizeof(Key) + sizeof(uint64_t) + 2 * sizeof(vsg::dvec3))) return false;
+
+    entries.clear();
+    entries.reserve(static_cast<size_t>(numEntries));
+    for (uint64_t i = 0; i < numEntries; ++i)
+    {
+        Key key;
+        Entry entry;
+        if (!readValue(fin, key) || !readValue(fin, entry.numPoints) || !readValue(fin, entry.bound.min) || !readValue(fin, entry.bound.max))
+        {
+            vsg::warn("BrickStore::readManifest() ", filename, " is truncated.");
+            return false;
+        }
+        entries[key] = entry;
+    }
+
+    return true;
+}
+
+bool BrickStore::writeManifest() const
+{
+    vsg::makeDirectory(directory);
+
+    auto filename = directory / "manifest.vsgpbs";
+    std::ofstream fout(filename, std::ios::out | std::ios::binary);
+    if (!fout)
+    {
+        vsg::warn("BrickStore::writeManifest() unable to open ", filename);
+        return false;
+    }
+
+    fout.write(storeMagic, sizeof(storeMagic));
+    writeValue(fout, storeVersion);
+    writeValue(fout, precision);
+    writeValue(fout, bits);
+    writeValue(fout, decimation);
+    writeValue(fout, static_cast<uint8_t>(additive ? 1 : 0));
+    writeValue(fout, static_cast<uint8_t>(subdivideBricks ? 1 : 0));
+    writeValue(fout, numPointsPerBlock);
+    writeValue(fout, packThreshold);
+    writeValue(fout, static_cast<uint8_t>(drawIndirect ? 1 : 0));
+    writeValue(fout, static_cast<uint8_t>(compressTiles ? 1 : 0));
+    writeValue(fout, keyOrigin);
+
+    auto extensionString = extension.string();
+    writeValue(fout, static_cast<uint32_t>(extensionString.size()));
+    fout.write(extensionString.data(), extensionString.size());
+
+    writeValue(fout, static_cast<uint64_t>(entries.size()));
+    for (auto& [key, entry] : entries)
+    {
+        writeValue(fout, key);
+        writeValue(fout, entry.numPoints);
+        writeValue(fout, entry.bound.min);
+        writeValue(fout, entry.bound.max);
+    }
+
+    fout.close();
+    if (fout.fail())
+    {
+        vsg::warn("BrickStore::writeManifest() unable to write ", filename);
+        removeManifest();
+        return false;
+    }
+
+    return true;
+}
+
+void BrickStore::removeManifest() const
+{
+    std::remove((directory / "manifest.vsgpbs").string().c_str());
+}
@@ -11,13 +11,296 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsgPoints/Bricks.h>
+#include <vsgPoints/parallel.h>
 
 #include <vsg/io/Logger.h>
 
+#include <vsg/io/FileSystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+
+// the AVX2 quantization kernel is compiled for x86 with GCC/Clang and selected at runtime when the CPU supports it,
+// or with other compilers when the build targets AVX2
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#    include <immintrin.h>
+#    define QUANTIZE_AVX2 1
+#    define QUANTIZE_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(__AVX2__)
+#    include <immintrin.h>
+#    define QUANTIZE_AVX2 1
+#    define QUANTIZE_AVX2_TARGET
+#else
+#    define QUANTIZE_AVX2 0
+#endif
 
 using namespace vsgPoints;
 
+namespace
+{
+    std::atomic<uint64_t> s_spillCount{0};
+
+    // bricks are spilled to a subdirectory of the scratch path unique to the process, so processes sharing a scratch path can't
+    // overwrite each other's spill files, with the subdirectories and any files left in them removed when the process exits
+    struct SpillDirectories
+    {
+        std::mutex mutex;
+        std::map<std::string, vsg::Path> directories;
+
+        vsg::Path directory(const vsg::Path& scratchPath)
+        {
+            // bricks may be spilled from several reading threads at once, so serialize the creation of the directories
+            std::scoped_lock<std::mutex> lock(mutex);
+
+            auto& directory = directories[scratchPath.string()];
+            if (!directory)
+            {
+                vsg::makeDirectory(scratchPath);
+
+                std::random_device random;
+                for (int attempt = 0; attempt < 16 && !directory; ++attempt)
+                {
+                    auto candidate = scratchPath / vsg::make_string("vsgPoints_", std::hex, random(), random());
+                    std::error_code ec;
+                    if (std::filesystem::create_directory(candidate.string(), ec)) directory = candidate;
+                }
+
+                if (!directory) vsg::warn("Bricks::spill() unable to create a spill directory in ", scratchPath);
+            }
+            return directory;
+        }
+
+        ~SpillDirectories()
+        {
+            for (auto& [scratchPath, directory] : directories)
+            {
+                std::error_code ec;
+                if (directory) std::filesystem::remove_all(directory.string(), ec);
+            }
+        }
+    };
+
+    SpillDirectories s_spillDirectories;
+
+    const size_t quantizeBlockSize = 256;
+
+    // brick keys and positions within the brick of a block of quantized vertices, along with the bound of the block's vertices.
+    // Vertices whose brick keys can't be represented are flagged as invalid and counted in numInvalid.
+    struct QuantizedBlock
+    {
+        int32_t key[3][quantizeBlockSize];
+        int32_t position[3][quantizeBlockSize];
+        uint8_t valid[quantizeBlockSize];
+        size_t numInvalid;
+        vsg::dvec3 min;
+        vsg::dvec3 max;
+    };
+
+    struct Quantizer
+    {
+        double multiplier; // 1.0 / precision
+        double brickScale; // 1.0 / 2^bits
+        double brickSize;  // 2^bits
+    };
+
+    // range of brick keys that can be converted to int32_t, keys outside it, including those of non finite vertices, are invalid
+    const double minimumKey = static_cast<double>(std::numeric_limits<int32_t>::min());
+    const double maximumKey = static_cast<double>(std::numeric_limits<int32_t>::max());
+
+    // vertices are quantized to the nearest multiple of the precision, rounding halfway cases away from zero as std::round does, then split into the
+    // brick key, the quantized position divided by 2^bits rounded towards negative infinity, and the position within the brick, the remainder.
+    // The steps are all exact in double precision so the scalar and AVX2 kernels produce identical results.
+    void quantizeScalar(const Quantizer& quantizer, const vsg::dvec3* vertices, size_t begin, size_t end, QuantizedBlock& block)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            bool valid = true;
+            for (int c = 0; c < 3; ++c)
+            {
+                double value = vertices[i][c];
+                block.min[c] = std::min(block.min[c], value);
+                block.max[c] = std::max(block.max[c], value);
+
+                double quantized = std::round(value * quantizer.multiplier);
+                double key = std::floor(quantized * quantizer.brickScale);
+                if (key >= minimumKey && key <= maximumKey)
+                {
+                    block.key[c][i] = static_cast<int32_t>(key);
+                    block.position[c][i] = static_cast<int32_t>(quantized - key * quantizer.brickSize);
+                }
+                else
+                {
+                    block.key[c][i] = 0;
+                    block.position[c][i] = 0;
+                    valid = false;
+                }
+            }
+
+            block.valid[i] = valid ? 1 : 0;
+            if (!valid) ++block.numInvalid;
+        }
+    }
+
+    void quantizeScalar(const Quantizer& quantizer, const vsg::dvec3* vertices, size_t count, QuantizedBlock& block)
+    {
+        quantizeScalar(quantizer, vertices, 0, count, block);
+    }
+
+#if QUANTIZE_AVX2
+    // process 4 vertices at a time, loading the 12 doubles of the 4 vertices and shuffling them into x, y and z registers
+    QUANTIZE_AVX2_TARGET void quantizeAVX2(const Quantizer& quantizer, const vsg::dvec3* vertices, size_t count, QuantizedBlock& block)
+    {
+        const __m256d multiplier = _mm256_set1_pd(quantizer.multiplier);
+        const __m256d half = _mm256_set1_pd(0.5);
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d signBit = _mm256_set1_pd(-0.0);
+        const __m256d minKey = _mm256_set1_pd(minimumKey);
+        const __m256d maxKey = _mm256_set1_pd(maximumKey);
+        const __m256d brickScale = _mm256_set1_pd(quantizer.brickScale);
+        const __m256d brickSize = _mm256_set1_pd(quantizer.brickSize);
+
+        __m256d min[3], max[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            min[c] = _mm256_set1_pd(block.min[c]);
+            max[c] = _mm256_set1_pd(block.max[c]);
+        }
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            // v0 = {x0, y0, z0, x1}, v1 = {y1, z1, x2, y2}, v2 = {z2, x3, y3, z3}
+            const double* base = &(vertices[i].x);
+            __m256d v0 = _mm256_loadu_pd(base);
+            __m256d v1 = _mm256_loadu_pd(base + 4);
+            __m256d v2 = _mm256_loadu_pd(base + 8);
+
+            __m256d values[3];
+            values[0] = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(v0, v2, 0b0110), v1, 0b0100), 0x6C); // {x0, x3, x2, x1} -> {x0, x1, x2, x3}
+            values[1] = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(v0, v1, 0b1001), v2, 0b0100), 0xB1); // {y1, y0, y3, y2} -> {y0, y1, y2, y3}
+            values[2] = _mm256_permute4x64_pd(_mm256_blend_pd(_mm256_blend_pd(v0, v1, 0b0010), v2, 0b1001), 0xC6); // {z2, z1, z0, z3} -> {z0, z1, z2, z3}
+
+            __m256d valid = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+            for (int c = 0; c < 3; ++c)
+            {
+                __m256d value = values[c];
+                min[c] = _mm256_min_pd(min[c], value);
+                max[c] = _mm256_max_pd(max[c], value);
+
+                // round halfway cases away from zero to match std::round, truncating then stepping away from zero when the exact fraction is at least 0.5
+                __m256d scaled = _mm256_mul_pd(value, multiplier);
+                __m256d truncated = _mm256_round_pd(scaled, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+                __m256d roundAway = _mm256_cmp_pd(_mm256_andnot_pd(signBit, _mm256_sub_pd(scaled, truncated)), half, _CMP_GE_OQ);
+                __m256d quantized = _mm256_add_pd(truncated, _mm256_and_pd(roundAway, _mm256_or_pd(one, _mm256_and_pd(signBit, scaled))));
+
+                __m256d key = _mm256_floor_pd(_mm256_mul_pd(quantized, brickScale));
+                __m256d position = _mm256_sub_pd(quantized, _mm256_mul_pd(key, brickSize));
+
+                // _mm256_cvttpd_epi32 silently converts out of range values to INT_MIN, so flag them, the ordered compares also flag NaN
+                valid = _mm256_and_pd(valid, _mm256_and_pd(_mm256_cmp_pd(key, minKey, _CMP_GE_OQ), _mm256_cmp_pd(key, maxKey, _CMP_LE_OQ)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(block.key[c] + i), _mm256_cvttpd_epi32(key));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(block.position[c] + i), _mm256_cvttpd_epi32(position));
+            }
+
+            int validMask = _mm256_movemask_pd(valid);
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                bool laneValid = ((validMask >> lane) & 1) != 0;
+                block.valid[i + lane] = laneValid ? 1 : 0;
+                if (!laneValid) ++block.numInvalid;
+            }
+        }
+
+        for (int c = 0; c < 3; ++c)
+        {
+            alignas(32) double lanes_min[4], lanes_max[4];
+            _mm256_store_pd(lanes_min, min[c]);
+            _mm256_store_pd(lanes_max, max[c]);
+            block.min[c] = std::min(std::min(lanes_min[0], lanes_min[1]), std::min(lanes_min[2], lanes_min[3]));
+            block.max[c] = std::max(std::max(lanes_max[0], lanes_max[1]), std::max(lanes_max[2], lanes_max[3]));
+        }
+
+        quantizeScalar(quantizer, vertices, i, count, block);
+    }
+#endif
+
+    using QuantizeKernel = void (*)(const Quantizer& quantizer, const vsg::dvec3* vertices, size_t count, QuantizedBlock& block);
+
+    QuantizeKernel selectQuantizeKernel()
+    {
+#if QUANTIZE_AVX2 && defined(__AVX2__)
+        return quantizeAVX2;
+#elif QUANTIZE_AVX2
+        if (__builtin_cpu_supports("avx2")) return quantizeAVX2;
+#endif
+        return quantizeScalar;
+    }
+
+    // quantize count vertices in blocks, expanding bound once per block and calling func(i, key, position) with the brick key and position within the brick of each vertex.
+    // Vertices that can't be quantized to a brick key are skipped and left out of the bound, returns the number skipped.
+    template<typename F>
+    size_t quantize(const Settings& settings, const vsg::dvec3* vertices, size_t count, vsg::dbox& bound, F func)
+    {
+        static const QuantizeKernel s_quantizeKernel = selectQuantizeKernel();
+
+        int bits = static_cast<int>(settings.bits);
+        Quantizer quantizer{1.0 / settings.precision, std::ldexp(1.0, -bits), std::ldexp(1.0, bits)};
+
+        size_t numInvalid = 0;
+        QuantizedBlock block;
+        for (size_t base = 0; base < count; base += quantizeBlockSize)
+        {
+            size_t n = std::min(quantizeBlockSize, count - base);
+
+            block.numInvalid = 0;
+            block.min.set(std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+            block.max.set(std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest());
+            s_quantizeKernel(quantizer, vertices + base, n, block);
+
+            if (block.numInvalid == 0)
+            {
+                bound.add(block.min);
+                bound.add(block.max);
+            }
+            else
+            {
+                // the block's min/max may hold the invalid vertices, so expand the bound by the valid vertices alone
+                for (size_t i = 0; i < n; ++i)
+                {
+                    if (block.valid[i]) bound.add(vertices[base + i]);
+                }
+                numInvalid += block.numInvalid;
+            }
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (!block.valid[i]) continue;
+
+                Key key(block.key[0][i], block.key[1][i], block.key[2][i], 1);
+                func(base + i, key, vsg::usvec3(static_cast<uint16_t>(block.position[0][i]), static_cast<uint16_t>(block.position[1][i]), static_cast<uint16_t>(block.position[2][i])));
+            }
+        }
+
+        return numInvalid;
+    }
+
+    void warnInvalid(size_t numInvalid)
+    {
+        if (numInvalid > 0) vsg::warn("Bricks::add() skipped ", numInvalid, " points that are not finite or lie outside the range of brick keys for the precision and bits.");
+    }
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Bricks
+//
 Bricks::Bricks(vsg::ref_ptr<Settings> in_settings) :
     settings(in_settings)
 {
@@ -25,43 +308,247 @@ Bricks::Bricks(vsg::ref_ptr<Settings> in_settings) :
 
 void Bricks::add(const vsg::dvec3& v, const vsg::ubvec4& c)
 {
-    settings->bound.add(v);
+    add(&v, &c, 1);
+}
+
+void Bricks::add(const vsg::dvec3* vertices, const vsg::ubvec4* colors, size_t count)
+{
+    vsg::dbox bound;
+
+    size_t numInvalid = quantize(*settings, vertices, count, bound, [&](size_t i, const Key& key, const vsg::usvec3& position) {
+        // consecutive points usually land in the same brick so only look up the brick when the key changes
+        if (!_currentBrick || key != _currentKey)
+        {
+            auto& brick = _bricks[key];
+            if (!brick) brick = Brick::create(settings->bits);
+
+            _currentBrick = brick.get();
+            _currentKey = key;
+        }
+
+        _currentBrick->add(position, colors[i]);
+    });
+
+    warnInvalid(numInvalid);
+
+    if (bound.valid()) settings->bound.add(bound);
+
+    if (settings->memoryBudget > 0)
+    {
+        _memoryEstimate += (count - numInvalid) * sizeof(PackedPoint);
+        if (_memoryEstimate > settings->memoryBudget) spill(*settings, settings->memoryBudget / 2);
+    }
+}
+
+void Bricks::addTwoPass(size_t numRanges, const BlockReader& reader)
+{
+    _currentBrick = nullptr;
+
+    // first pass, count the points landing in each brick for each range
+    std::vector<KeyCounts> rangeCounts(numRanges);
+    std::vector<vsg::dbox> rangeBounds(numRanges);
+    std::vector<size_t> rangeInvalid(numRanges, 0);
+    parallel_for(*settings, numRanges, [&](size_t r) {
+        auto& counts = rangeCounts[r];
+        auto& bound = rangeBounds[r];
+        reader(r, [&](const vsg::dvec3* vertices, const vsg::ubvec4*, size_t count) {
+            Key currentKey;
+            size_t* currentCount = nullptr;
+            rangeInvalid[r] += quantize(*settings, vertices, count, bound, [&](size_t, const Key& key, const vsg::usvec3&) {
+                if (!currentCount || key != currentKey)
+                {
+                    currentCount = &counts[key];
+                    currentKey = key;
+                }
+                ++(*currentCount);
+            });
+        });
+    });
+
+    size_t numInvalid = 0;
+    for (auto count : rangeInvalid) numInvalid += count;
+    warnInvalid(numInvalid);
+
+    // convert the counts into the index each range starts writing at within each brick, then size the bricks exactly
+    KeyCounts totals;
+    std::vector<std::pair<Brick*, size_t>> newPoints;
+    for (size_t r = 0; r < numRanges; ++r)
+    {
+        if (rangeBounds[r].valid()) settings->bound.add(rangeBounds[r]);
 
-    auto divide_round = [](int64_t value, int64_t divisor) -> int64_t {
-        if (value < 0)
-            return -1 - (-value / divisor);
+        for (auto& [key, count] : rangeCounts[r])
+        {
+            auto& total = totals[key];
+            if (total == 0)
+            {
+                auto& brick = _bricks[key];
+                if (!brick) brick = Brick::create(settings->bits);
+                total = brick->size();
+                newPoints.emplace_back(brick.get(), total);
+            }
+
+            size_t start = total;
+            total += count;
+            count = start;
+        }
+    }
+
+    for (auto& [key, total] : totals)
+    {
+        _bricks.find(key)->second->resize(total);
+    }
+
+    // second pass, quantize the points again and write them into place, each range writes its own indices so no locking is required
+    parallel_for(*settings, numRanges, [&](size_t r) {
+        auto& offsets = rangeCounts[r];
+        vsg::dbox bound;
+        reader(r, [&](const vsg::dvec3* vertices, const vsg::ubvec4* colors, size_t count) {
+            Key currentKey;
+            Brick* currentBrick = nullptr;
+            size_t* currentOffset = nullptr;
+            quantize(*settings, vertices, count, bound, [&](size_t i, const Key& key, const vsg::usvec3& position) {
+                if (!currentBrick || key != currentKey)
+                {
+                    currentBrick = _bricks.find(key)->second.get();
+                    currentOffset = &(offsets.find(key)->second);
+                    currentKey = key;
+                }
+                currentBrick->write((*currentOffset)++, PackedPoint{position, colors[i]});
+            });
+        });
+    });
+
+    // the ranges write to the same bricks concurrently, so the bricks' bounds are expanded to include their new points once all the ranges are written
+    size_t numTasks = std::min(newPoints.size(), concurrency(*settings) * 16);
+    parallel_for(*settings, numTasks, [&](size_t task) {
+        size_t begin = (newPoints.size() * task) / numTasks;
+        size_t end = (newPoints.size() * (task + 1)) / numTasks;
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& [brick, first] = newPoints[i];
+            brick->expandVertexBound(first, brick->size() - first);
+        }
+    });
+
+    // all the points are placed in memory before any can be spilled, so with a memory budget spill down to it once they're in place
+    if (settings->memoryBudget > 0 && memoryUsed() > settings->memoryBudget) spill(*settings, settings->memoryBudget / 2);
+}
+
+bool Bricks::merge(Bricks& source)
+{
+    bool result = true;
+
+    if (source.settings != settings) settings->bound.add(source.settings->bound);
+
+    _currentBrick = nullptr;
+    source._currentBrick = nullptr;
+
+    for (auto& [key, source_brick] : source._bricks)
+    {
+        auto& brick = _bricks[key];
+        if (!brick)
+        {
+            brick = source_brick;
+        }
         else
-            return value / divisor;
-    };
+        {
+            if (!source_brick->restore()) result = false;
+            brick->append(*source_brick);
+        }
+    }
+
+    source.clear();
+
+    if (settings && settings->memoryBudget > 0 && memoryUsed() > settings->memoryBudget) spill(*settings, settings->memoryBudget / 2);
 
-    double multiplier = 1.0 / settings->precision;
-    int64_t divisor = 1 << settings->bits;
+    return result;
+}
+
+size_t Bricks::memoryUsed() const
+{
+    size_t total = 0;
+    for (auto& [key, brick] : _bricks)
+    {
+        total += brick->memoryUsed();
+    }
+    return total;
+}
+
+void Bricks::spill(const Settings& local_settings, size_t maxMemory)
+{
+    std::vector<Brick*> candidates;
+    candidates.reserve(_bricks.size());
+
+    size_t used = 0;
+    for (auto& [key, brick] : _bricks)
+    {
+        used += brick->memoryUsed();
+        if (brick->size() > 0) candidates.push_back(brick.get());
+    }
 
-    vsg::dvec3 scaled_v = v * multiplier;
-    vsg::dvec3 rounded_v = {std::round(scaled_v.x), std::round(scaled_v.y), std::round(scaled_v.z)};
-    vsg::t_vec3<int64_t> int64_v = {static_cast<int64_t>(rounded_v.x), static_cast<int64_t>(rounded_v.y), static_cast<int64_t>(rounded_v.z)};
-    vsg::t_vec3<int64_t> int64_key = {divide_round(int64_v.x, divisor), divide_round(int64_v.y, divisor), divide_round(int64_v.z, divisor)};
-    Key key = {static_cast<int32_t>(int64_key.x), static_cast<int32_t>(int64_key.y), static_cast<int32_t>(int64_key.z), 1};
+    _memoryEstimate = used;
+    if (used <= maxMemory) return;
 
-    PackedPoint packedPoint;
-    packedPoint.v.set(int64_v.x - key.x * divisor, int64_v.y - key.y * divisor, int64_v.z - key.z * divisor);
-    packedPoint.c.set(c.r, c.g, c.b, c.a);
+    auto spillDirectory = s_spillDirectories.directory(local_settings.scratchPath ? local_settings.scratchPath : vsg::Path(std::filesystem::temp_directory_path().string()));
+    if (!spillDirectory) return;
 
-    auto& brick = bricks[key];
-    if (!brick)
+    // spill the largest bricks first as they free the most memory per file
+    std::sort(candidates.begin(), candidates.end(), [](const Brick* lhs, const Brick* rhs) { return lhs->size() > rhs->size(); });
+    for (auto brick : candidates)
     {
-        brick = Brick::create();
+        if (used <= maxMemory) break;
+
+        if (!brick->spillFilename) brick->spillFilename = spillDirectory / vsg::make_string("brick_", s_spillCount++, ".spill");
+        used -= std::min(used, brick->spill());
     }
 
-    brick->points.push_back(packedPoint);
+    _memoryEstimate = used;
+    _currentBrick = nullptr;
+}
+
+vsg::ref_ptr<Bricks> Bricks::createEmpty() const
+{
+    auto local_settings = Settings::create();
+    local_settings->numPointsPerBlock = settings->numPointsPerBlock;
+    local_settings->precision = settings->precision;
+    local_settings->bits = settings->bits;
+    local_settings->memoryMapFiles = settings->memoryMapFiles;
+    local_settings->scratchPath = settings->scratchPath;
+
+    // the per range Bricks are filled concurrently so share the memory budget between them
+    local_settings->memoryBudget = settings->memoryBudget / concurrency(*settings);
+
+    return Bricks::create(local_settings);
+}
+
+void Bricks::clear()
+{
+    _bricks.clear();
+    _currentBrick = nullptr;
+    _memoryEstimate = 0;
+}
+
+void Bricks::swap(Bricks& rhs)
+{
+    std::swap(_bricks, rhs._bricks);
+    std::swap(_memoryEstimate, rhs._memoryEstimate);
+    _currentBrick = nullptr;
+    rhs._currentBrick = nullptr;
+}
+
+Bricks::SortedBricks Bricks::sorted() const
+{
+    SortedBricks sortedBricks(_bricks.begin(), _bricks.end());
+    std::sort(sortedBricks.begin(), sortedBricks.end(), [](const SortedBricks::value_type& lhs, const SortedBricks::value_type& rhs) { return lhs.first < rhs.first; });
+    return sortedBricks;
 }
 
 size_t Bricks::count() const
 {
     size_t num = 0;
-    for (auto& [key, brick] : bricks)
+    for (auto& [key, brick] : _bricks)
     {
-        num += brick->points.size();
+        num += brick->size() + brick->numSpilled();
     }
     return num;
 }
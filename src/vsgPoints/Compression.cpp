@@ -0,0 +1,333 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/Compression.h>
+
+#include <algorithm>
+#include <array>
+
+using namespace vsgPoints;
+
+namespace
+{
+    // rANS coder with 12 bit symbol probabilities and a 32 bit state renormalized a byte at a time
+    const uint32_t probabilityBits = 12;
+    const uint32_t probabilityScale = 1 << probabilityBits;
+    const uint32_t ransLowerBound = 1 << 23;
+
+    using Frequencies = std::array<uint32_t, 256>;
+
+    // scale the symbol counts so they sum to probabilityScale, keeping every symbol that occurs at a frequency of at least 1
+    void normalizeFrequencies(Frequencies& freqs, size_t total)
+    {
+        uint32_t sum = 0;
+        for (auto& freq : freqs)
+        {
+            if (freq == 0) continue;
+            freq = std::max(1u, static_cast<uint32_t>((static_cast<uint64_t>(freq) * probabilityScale) / total));
+            sum += freq;
+        }
+
+        while (sum != probabilityScale)
+        {
+            auto largest = std::max_element(freqs.begin(), freqs.end());
+            if (sum < probabilityScale)
+            {
+                *largest += probabilityScale - sum;
+                sum = probabilityScale;
+            }
+            else
+            {
+                // at most 256 symbols share probabilityScale so the largest always has frequency to spare
+                uint32_t reduction = std::min(sum - probabilityScale, *largest - 1);
+                *largest -= reduction;
+                sum -= reduction;
+            }
+        }
+    }
+
+    uint64_t spreadBits(uint64_t v)
+    {
+        // spread the lower 16 bits so there are two zero bits between each
+        v &= 0xffff;
+        v = (v | (v << 16)) & 0x0000ff0000ff;
+        v = (v | (v << 8)) & 0x00f00f00f00f;
+        v = (v | (v << 4)) & 0x0c30c30c30c3;
+        v = (v | (v << 2)) & 0x249249249249;
+        return v;
+    }
+
+    uint32_t compactBits(uint64_t v)
+    {
+        v &= 0x249249249249;
+        v = (v | (v >> 2)) & 0x0c30c30c30c3;
+        v = (v | (v >> 4)) & 0x00f00f00f00f;
+        v = (v | (v >> 8)) & 0x0000ff0000ff;
+        v = (v | (v >> 16)) & 0xffff;
+        return static_cast<uint32_t>(v);
+    }
+
+    uint64_t mortonCode(const vsg::uivec3& v)
+    {
+        return spreadBits(v.x) | (spreadBits(v.y) << 1) | (spreadBits(v.z) << 2);
+    }
+
+    vsg::uivec3 mortonDecode(uint64_t code)
+    {
+        return vsg::uivec3(compactBits(code), compactBits(code >> 1), compactBits(code >> 2));
+    }
+
+    vsg::uivec3 unpackVertex(uint32_t bits, const uint8_t* vertices, size_t i)
+    {
+        if (bits == 8)
+        {
+            auto v = reinterpret_cast<const vsg::ubvec3*>(vertices)[i];
+            return vsg::uivec3(v.x, v.y, v.z);
+        }
+        else if (bits == 10)
+        {
+            auto v = reinterpret_cast<const uint32_t*>(vertices)[i];
+            return vsg::uivec3((v >> 20) & 0x3ff, (v >> 10) & 0x3ff, v & 0x3ff);
+        }
+        else
+        {
+            auto v = reinterpret_cast<const vsg::usvec3*>(vertices)[i];
+            return vsg::uivec3(v.x, v.y, v.z);
+        }
+    }
+
+    void packVertex(uint32_t bits, uint8_t* vertices, size_t i, const vsg::uivec3& v)
+    {
+        if (bits == 8)
+        {
+            reinterpret_cast<vsg::ubvec3*>(vertices)[i].set(static_cast<uint8_t>(v.x), static_cast<uint8_t>(v.y), static_cast<uint8_t>(v.z));
+        }
+        else if (bits == 10)
+        {
+            reinterpret_cast<uint32_t*>(vertices)[i] = 3 << 30 | (v.x << 20) | (v.y << 10) | v.z;
+        }
+        else
+        {
+            reinterpret_cast<vsg::usvec3*>(vertices)[i].set(static_cast<uint16_t>(v.x), static_cast<uint16_t>(v.y), static_cast<uint16_t>(v.z));
+        }
+    }
+} // namespace
+
+void vsgPoints::writeVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool vsgPoints::readVarint(const uint8_t*& ptr, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (uint32_t shift = 0; ptr != end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *(ptr++);
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+void vsgPoints::entropyEncode(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+{
+    writeVarint(out, size);
+    if (size == 0) return;
+
+    Frequencies freqs{};
+    for (size_t i = 0; i < size; ++i) ++freqs[data[i]];
+    normalizeFrequencies(freqs, size);
+
+    Frequencies starts{};
+    uint32_t numSymbols = 0;
+    for (uint32_t s = 0, start = 0; s < 256; ++s)
+    {
+        starts[s] = start;
+        start += freqs[s];
+        if (freqs[s] != 0) ++numSymbols;
+    }
+
+    writeVarint(out, numSymbols);
+    for (uint32_t s = 0; s < 256; ++s)
+    {
+        if (freqs[s] == 0) continue;
+        out.push_back(static_cast<uint8_t>(s));
+        writeVarint(out, freqs[s]);
+    }
+
+    // rANS encodes in reverse so the decoder can run forwards, so fill the buffer from the back
+    std::vector<uint8_t> buffer(size + size / 2 + 16);
+    uint8_t* ptr = buffer.data() + buffer.size();
+
+    uint32_t state = ransLowerBound;
+    for (size_t i = size; i > 0; --i)
+    {
+        uint8_t symbol = data[i - 1];
+        uint32_t freq = freqs[symbol];
+
+        uint32_t maxState = ((ransLowerBound >> probabilityBits) << 8) * freq;
+        while (state >= maxState)
+        {
+            if (ptr == buffer.data())
+            {
+                // incompressible data can exceed the estimate, so grow the buffer keeping the bytes already written at its end
+                size_t used = buffer.size();
+                buffer.insert(buffer.begin(), used, 0);
+                ptr = buffer.data() + used;
+            }
+            *(--ptr) = static_cast<uint8_t>(state & 0xff);
+            state >>= 8;
+        }
+        state = ((state / freq) << probabilityBits) + (state % freq) + starts[symbol];
+    }
+
+    uint8_t finalState[4] = {static_cast<uint8_t>(state), static_cast<uint8_t>(state >> 8), static_cast<uint8_t>(state >> 16), static_cast<uint8_t>(state >> 24)};
+
+    size_t encodedSize = static_cast<size_t>(buffer.data() + buffer.size() - ptr);
+    writeVarint(out, encodedSize + 4);
+    out.insert(out.end(), finalState, finalState + 4);
+    out.insert(out.end(), ptr, ptr + encodedSize);
+}
+
+bool vsgPoints::entropyDecode(const uint8_t*& ptr, const uint8_t* end, std::vector<uint8_t>& out, size_t maxSize)
+{
+    uint64_t size = 0;
+    if (!readVarint(ptr, end, size) || size > maxSize) return false;
+
+    out.resize(static_cast<size_t>(size));
+    if (size == 0) return true;
+
+    uint64_t numSymbols = 0;
+    if (!readVarint(ptr, end, numSymbols) || numSymbols == 0 || numSymbols > 256) return false;
+
+    Frequencies freqs{};
+    Frequencies starts{};
+    std::array<uint8_t, probabilityScale> symbols;
+    uint32_t start = 0;
+    for (uint64_t i = 0; i < numSymbols; ++i)
+    {
+        uint64_t freq = 0;
+        if (ptr == end) return false;
+        uint8_t symbol = *(ptr++);
+        if (!readVarint(ptr, end, freq) || freq == 0 || start + freq > probabilityScale) return false;
+
+        freqs[symbol] = static_cast<uint32_t>(freq);
+        starts[symbol] = start;
+        std::fill(symbols.begin() + start, symbols.begin() + start + freq, symbol);
+        start += static_cast<uint32_t>(freq);
+    }
+    if (start != probabilityScale) return false;
+
+    uint64_t encodedSize = 0;
+    if (!readVarint(ptr, end, encodedSize) || encodedSize < 4 || encodedSize > static_cast<uint64_t>(end - ptr)) return false;
+
+    const uint8_t* stream = ptr;
+    const uint8_t* streamEnd = ptr + encodedSize;
+    ptr = streamEnd;
+
+    uint32_t state = static_cast<uint32_t>(stream[0]) | (static_cast<uint32_t>(stream[1]) << 8) | (static_cast<uint32_t>(stream[2]) << 16) | (static_cast<uint32_t>(stream[3]) << 24);
+    stream += 4;
+
+    for (auto& value : out)
+    {
+        uint32_t slot = state & (probabilityScale - 1);
+        uint8_t symbol = symbols[slot];
+        value = symbol;
+
+        state = freqs[symbol] * (state >> probabilityBits) + slot - starts[symbol];
+        while (state < ransLowerBound)
+        {
+            if (stream == streamEnd) return false;
+            state = (state << 8) | *(stream++);
+        }
+    }
+
+    return true;
+}
+
+void vsgPoints::compressBrick(uint32_t bits, uint32_t numPoints, const void* vertices, const vsg::ubvec4* colors, std::vector<uint8_t>& out)
+{
+    auto vertexData = static_cast<const uint8_t*>(vertices);
+
+    std::vector<std::pair<uint64_t, uint32_t>> codes(numPoints);
+    for (uint32_t i = 0; i < numPoints; ++i)
+    {
+        codes[i] = {mortonCode(unpackVertex(bits, vertexData, i)), i};
+    }
+    std::sort(codes.begin(), codes.end());
+
+    // positions as the varint coded differences between successive Morton codes
+    std::vector<uint8_t> positionBytes;
+    positionBytes.reserve(numPoints * 2);
+    uint64_t previousCode = 0;
+    for (auto& [code, index] : codes)
+    {
+        writeVarint(positionBytes, code - previousCode);
+        previousCode = code;
+    }
+    entropyEncode(positionBytes.data(), positionBytes.size(), out);
+
+    // colors as per channel differences from the previous point, with each channel in its own stream as they have different statistics
+    std::vector<uint8_t> channelBytes(numPoints);
+    for (size_t channel = 0; channel < 4; ++channel)
+    {
+        uint8_t previous = 0;
+        for (uint32_t i = 0; i < numPoints; ++i)
+        {
+            uint8_t value = colors[codes[i].second][channel];
+            channelBytes[i] = static_cast<uint8_t>(value - previous);
+            previous = value;
+        }
+        entropyEncode(channelBytes.data(), channelBytes.size(), out);
+    }
+}
+
+bool vsgPoints::decompressBrick(const uint8_t*& ptr, const uint8_t* end, uint32_t bits, uint32_t numPoints, void* vertices, vsg::ubvec4* colors)
+{
+    if (bits != 8 && bits != 10 && bits != 16) return false;
+
+    // each position is a varint coded delta between 48 bit Morton codes, so takes at most 7 bytes
+    std::vector<uint8_t> bytes;
+    if (!entropyDecode(ptr, end, bytes, static_cast<size_t>(numPoints) * 7)) return false;
+
+    auto vertexData = static_cast<uint8_t*>(vertices);
+    const uint8_t* bytes_ptr = bytes.data();
+    const uint8_t* bytes_end = bytes_ptr + bytes.size();
+    uint64_t code = 0;
+    for (uint32_t i = 0; i < numPoints; ++i)
+    {
+        uint64_t delta = 0;
+        if (!readVarint(bytes_ptr, bytes_end, delta)) return false;
+        code += delta;
+        packVertex(bits, vertexData, i, mortonDecode(code));
+    }
+
+    for (size_t channel = 0; channel < 4; ++channel)
+    {
+        if (!entropyDecode(ptr, end, bytes, numPoints) || bytes.size() != numPoints) return false;
+
+        uint8_t value = 0;
+        for (uint32_t i = 0; i < numPoints; ++i)
+        {
+            value = static_cast<uint8_t>(value + bytes[i]);
+            colors[i][channel] = value;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,636 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/Compression.h>
+#include <vsgPoints/MappedFile.h>
+#include <vsgPoints/PointsTile.h>
+
+#include <vsg/commands/BindVertexBuffers.h>
+#include <vsg/commands/Commands.h>
+#include <vsg/commands/Draw.h>
+#include <vsg/commands/DrawIndirect.h>
+#include <vsg/io/FileSystem.h>
+#include <vsg/io/Logger.h>
+#include <vsg/io/Options.h>
+#include <vsg/nodes/CullNode.h>
+#include <vsg/nodes/LOD.h>
+#include <vsg/nodes/PagedLOD.h>
+#include <vsg/nodes/VertexDraw.h>
+#include <vsg/utils/SharedObjects.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <typeinfo>
+
+using namespace vsgPoints;
+
+namespace
+{
+    /// Tile layout, all values in the native byte order of the machine that wrote the tile:
+    ///   header : char[4] "vsgT", uint32_t version
+    ///   node   : uint8_t type followed by the type specific fields
+    ///     NODE_NULL, NODE_EMPTY : no fields
+    ///     NODE_GROUP    : uint32_t numChildren, node[numChildren]
+    ///     NODE_CULLNODE : dsphere bound, node child
+    ///     NODE_LOD      : dsphere bound, uint32_t numChildren, {double minimumScreenHeightRatio, node child}[numChildren]
+    ///     NODE_PAGEDLOD : dsphere bound, double minimumScreenHeightRatio, uint32_t length, char[length] filename, node lowResChild
+    ///     NODE_BRICK    : uint8_t bits, uint32_t numPoints, vec4 positionScale, vec2 pointSize, packed vertices[numPoints], ubvec4 colors[numPoints]
+    ///     NODE_COMPRESSED_BRICK : as NODE_BRICK but with the vertices and colors replaced by uint32_t size, char[size] output of compressBrick(),
+    ///                     zero padded to at least numPoints / maxPointsPerCompressedByte bytes
+    ///     NODE_PACKED   : uint8_t bits, uint32_t numDraws, {uint32_t numPoints, vec4 positionScale, vec2 pointSize}[numDraws],
+    ///                     then for each draw packed vertices[numPoints], ubvec4 colors[numPoints]
+    ///     NODE_COMPRESSED_PACKED : as NODE_PACKED but with each draw's vertices and colors compressed as in NODE_COMPRESSED_BRICK
+    ///     NODE_PACKED_INDIRECT, NODE_COMPRESSED_PACKED_INDIRECT : as NODE_PACKED and NODE_COMPRESSED_PACKED, drawn with a single DrawIndirect
+    /// NODE_COMPRESSED_BRICK was added within version 1, version 2 added the packed node types and version 3 the padding of compressed points.
+    /// Earlier versions are still read, other than any compressed points packed more densely than maxPointsPerCompressedByte.
+    const char tileMagic[4] = {'v', 's', 'g', 'T'};
+    const uint32_t tileVersion = 3;
+
+    /// entropy coding can reduce highly regular points to almost nothing, so compressed points are padded to bound the number of points,
+    /// and so the memory allocated for them, that the decoder accepts per byte of a tile.
+    const uint32_t maxPointsPerCompressedByte = 16;
+
+    /// maximum nesting of nodes the decoder accepts, well beyond that of the tiles written, so corrupt tiles of deeply nested nodes can't overflow the stack.
+    const uint32_t maxNodeDepth = 256;
+
+    enum NodeType : uint8_t
+    {
+        NODE_NULL,
+        NODE_EMPTY,
+        NODE_GROUP,
+        NODE_CULLNODE,
+        NODE_LOD,
+        NODE_PAGEDLOD,
+        NODE_BRICK,
+        NODE_COMPRESSED_BRICK,
+        NODE_PACKED,
+        NODE_COMPRESSED_PACKED,
+        NODE_PACKED_INDIRECT,
+        NODE_COMPRESSED_PACKED_INDIRECT
+    };
+
+    size_t vertexSize(uint8_t bits)
+    {
+        switch (bits)
+        {
+        case (8): return sizeof(vsg::ubvec3);
+        case (10): return sizeof(uint32_t);
+        case (16): return sizeof(vsg::usvec3);
+        default: return 0;
+        }
+    }
+
+    uint8_t formatBits(VkFormat format)
+    {
+        switch (format)
+        {
+        case (VK_FORMAT_R8G8B8_UNORM): return 8;
+        case (VK_FORMAT_A2R10G10B10_UNORM_PACK32): return 10;
+        case (VK_FORMAT_R16G16B16_UNORM): return 16;
+        default: return 0;
+        }
+    }
+
+    vsg::ref_ptr<vsg::Data> createVertices(uint8_t bits, uint32_t numPoints)
+    {
+        switch (bits)
+        {
+        case (8): return vsg::ubvec3Array::create(numPoints, vsg::Data::Properties(VK_FORMAT_R8G8B8_UNORM));
+        case (10): return vsg::uintArray::create(numPoints, vsg::Data::Properties(VK_FORMAT_A2R10G10B10_UNORM_PACK32));
+        case (16): return vsg::usvec3Array::create(numPoints, vsg::Data::Properties(VK_FORMAT_R16G16B16_UNORM));
+        default: return {};
+        }
+    }
+
+    struct Encoder
+    {
+        std::ostream& out;
+        bool compress = false;
+
+        template<typename T>
+        void write(const T& value) { out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+        void write(const void* data, size_t size) { out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size)); }
+
+        void write(const vsg::dsphere& bound)
+        {
+            write(bound.center.x);
+            write(bound.center.y);
+            write(bound.center.z);
+            write(bound.radius);
+        }
+
+        bool encode(const vsg::Node* node)
+        {
+            if (!node)
+            {
+                write(NODE_NULL);
+                return true;
+            }
+
+            if (auto plod = node->cast<vsg::PagedLOD>())
+            {
+                std::string filename = plod->filename.string();
+                write(NODE_PAGEDLOD);
+                write(plod->bound);
+                write(plod->children[0].minimumScreenHeightRatio);
+                write(static_cast<uint32_t>(filename.size()));
+                write(filename.data(), filename.size());
+                return encode(plod->children[1].node);
+            }
+            else if (auto lod = node->cast<vsg::LOD>())
+            {
+                write(NODE_LOD);
+                write(lod->bound);
+                write(static_cast<uint32_t>(lod->children.size()));
+                for (auto& child : lod->children)
+                {
+                    write(child.minimumScreenHeightRatio);
+                    if (!encode(child.node)) return false;
+                }
+                return true;
+            }
+            else if (auto cullNode = node->cast<vsg::CullNode>())
+            {
+                write(NODE_CULLNODE);
+                write(cullNode->bound);
+                return encode(cullNode->child);
+            }
+            else if (auto vertexDraw = node->cast<vsg::VertexDraw>())
+            {
+                return encode(*vertexDraw);
+            }
+            else if (auto commands = node->cast<vsg::Commands>())
+            {
+                return encode(*commands);
+            }
+            else if (auto group = node->cast<vsg::Group>())
+            {
+                write(NODE_GROUP);
+                write(static_cast<uint32_t>(group->children.size()));
+                for (auto& child : group->children)
+                {
+                    if (!encode(child)) return false;
+                }
+                return true;
+            }
+            else if (typeid(*node) == typeid(vsg::Node))
+            {
+                write(NODE_EMPTY);
+                return true;
+            }
+
+            vsg::warn("PointsTile: unsupported node type in tile.");
+            return false;
+        }
+
+        bool encode(const vsg::VertexDraw& vertexDraw)
+        {
+            // arrays are assigned by Brick::createRendering() as {vertices, normals, colors, positionScale, pointSize}
+            auto& arrays = vertexDraw.arrays;
+            if (arrays.size() != 5 || !arrays[0] || !arrays[2] || !arrays[3] || !arrays[4])
+            {
+                vsg::warn("PointsTile: unsupported VertexDraw layout.");
+                return false;
+            }
+
+            auto vertices = arrays[0]->data;
+            auto colors = arrays[2]->data;
+            auto positionScale = arrays[3]->data.cast<vsg::vec4Value>();
+            auto pointSize = arrays[4]->data.cast<vsg::vec2Value>();
+
+            uint8_t bits = formatBits(vertices->properties.format);
+
+            // draws of subdivided bricks share their brick's arrays, each drawing its own range of them
+            uint32_t numPoints = vertexDraw.vertexCount;
+            size_t first = vertexDraw.firstVertex;
+            if (bits == 0 || !positionScale || !pointSize || vertices->dataSize() < (first + numPoints) * vertexSize(bits) || colors->dataSize() < (first + numPoints) * sizeof(vsg::ubvec4))
+            {
+                vsg::warn("PointsTile: unsupported VertexDraw arrays.");
+                return false;
+            }
+
+            auto vertexData = static_cast<const uint8_t*>(vertices->dataPointer()) + first * vertexSize(bits);
+            auto colorData = static_cast<const vsg::ubvec4*>(colors->dataPointer()) + first;
+
+            write(compress ? NODE_COMPRESSED_BRICK : NODE_BRICK);
+            write(bits);
+            write(numPoints);
+            write(positionScale->value());
+            write(pointSize->value());
+            writePoints(bits, numPoints, vertexData, colorData);
+            return true;
+        }
+
+        bool encode(const vsg::Commands& commands)
+        {
+            // commands are created by Brick::createPackedRendering() as a BindVertexBuffers of {vertices, normals, colors, positionScales, pointSizes}
+            // followed by a Draw per brick, each drawing its own range of the vertices with its own instance of the positionScales and pointSizes,
+            // or a single DrawIndirect of the equivalent draw commands.
+            auto bindVertexBuffers = commands.children.empty() ? nullptr : commands.children.front()->cast<vsg::BindVertexBuffers>();
+            if (!bindVertexBuffers)
+            {
+                vsg::warn("PointsTile: unsupported Commands layout.");
+                return false;
+            }
+
+            auto& arrays = bindVertexBuffers->arrays;
+            if (arrays.size() != 5 || !arrays[0] || !arrays[2] || !arrays[3] || !arrays[4])
+            {
+                vsg::warn("PointsTile: unsupported Commands layout.");
+                return false;
+            }
+
+            auto vertices = arrays[0]->data;
+            auto colors = arrays[2]->data;
+            auto positionScales = arrays[3]->data.cast<vsg::vec4Array>();
+            auto pointSizes = arrays[4]->data.cast<vsg::vec2Array>();
+
+            uint8_t bits = formatBits(vertices->properties.format);
+            if (bits == 0 || !positionScales || !pointSizes)
+            {
+                vsg::warn("PointsTile: unsupported Commands arrays.");
+                return false;
+            }
+
+            std::vector<vsg::DrawIndirectCommand> draws;
+            bool indirect = false;
+            for (auto itr = std::next(commands.children.begin()); itr != commands.children.end(); ++itr)
+            {
+                if (auto draw = (*itr)->cast<vsg::Draw>())
+                {
+                    draws.push_back(vsg::DrawIndirectCommand{draw->vertexCount, draw->instanceCount, draw->firstVertex, draw->firstInstance});
+                }
+                else if (auto drawIndirect = (*itr)->cast<vsg::DrawIndirect>(); drawIndirect && !indirect && draws.empty() && drawIndirect->bufferInfo)
+                {
+                    auto drawCommands = drawIndirect->bufferInfo->data.cast<vsg::DrawIndirectCommandArray>();
+                    if (!drawCommands || drawCommands->size() < drawIndirect->drawCount)
+                    {
+                        vsg::warn("PointsTile: unsupported DrawIndirect commands.");
+                        return false;
+                    }
+
+                    draws.insert(draws.end(), drawCommands->begin(), drawCommands->begin() + drawIndirect->drawCount);
+                    indirect = true;
+                }
+                else
+                {
+                    vsg::warn("PointsTile: unsupported Commands draw.");
+                    return false;
+                }
+            }
+
+            for (auto& draw : draws)
+            {
+                if (draw.instanceCount != 1 || draw.firstInstance >= positionScales->size() || draw.firstInstance >= pointSizes->size() ||
+                    vertices->dataSize() < (draw.firstVertex + draw.vertexCount) * vertexSize(bits) || colors->dataSize() < (draw.firstVertex + draw.vertexCount) * sizeof(vsg::ubvec4))
+                {
+                    vsg::warn("PointsTile: unsupported Commands draw.");
+                    return false;
+                }
+            }
+
+            if (indirect) write(compress ? NODE_COMPRESSED_PACKED_INDIRECT : NODE_PACKED_INDIRECT);
+            else write(compress ? NODE_COMPRESSED_PACKED : NODE_PACKED);
+
+            write(bits);
+            write(static_cast<uint32_t>(draws.size()));
+            for (auto& draw : draws)
+            {
+                write(draw.vertexCount);
+                write(positionScales->at(draw.firstInstance));
+                write(pointSizes->at(draw.firstInstance));
+            }
+
+            for (auto& draw : draws)
+            {
+                auto vertexData = static_cast<const uint8_t*>(vertices->dataPointer()) + draw.firstVertex * vertexSize(bits);
+                auto colorData = static_cast<const vsg::ubvec4*>(colors->dataPointer()) + draw.firstVertex;
+                writePoints(bits, draw.vertexCount, vertexData, colorData);
+            }
+            return true;
+        }
+
+        void writePoints(uint8_t bits, uint32_t numPoints, const void* vertexData, const vsg::ubvec4* colorData)
+        {
+            if (compress)
+            {
+                std::vector<uint8_t> compressed;
+                compressBrick(bits, numPoints, vertexData, colorData, compressed);
+                if (compressed.size() < numPoints / maxPointsPerCompressedByte) compressed.resize(numPoints / maxPointsPerCompressedByte, 0);
+
+                write(static_cast<uint32_t>(compressed.size()));
+                write(compressed.data(), compressed.size());
+            }
+            else
+            {
+                write(vertexData, numPoints * vertexSize(bits));
+                write(colorData, numPoints * sizeof(vsg::ubvec4));
+            }
+        }
+    };
+
+    struct Decoder
+    {
+        const uint8_t* ptr;
+        const uint8_t* end;
+        vsg::ref_ptr<const vsg::Options> options;
+        vsg::ref_ptr<vsg::vec3Value> normals;
+
+        template<typename T>
+        bool read(T& value) { return read(&value, sizeof(T)); }
+
+        // replace data with an identical object already held by the options->sharedObjects, so tiles don't each hold their own copy
+        template<class T>
+        void share(vsg::ref_ptr<T>& data)
+        {
+            if (options && options->sharedObjects) options->sharedObjects->share(data);
+        }
+
+        bool read(void* data, size_t size)
+        {
+            if (static_cast<size_t>(end - ptr) < size) return false;
+            std::memcpy(data, ptr, size);
+            ptr += size;
+            return true;
+        }
+
+        // check that at least size bytes remain, so counts read from the tile are validated before anything is allocated for them
+        bool available(uint64_t size) const
+        {
+            return size <= static_cast<uint64_t>(end - ptr);
+        }
+
+        // minimum number of bytes that numPoints points can be encoded in
+        uint64_t minimumPointsSize(uint8_t bits, uint32_t numPoints, bool compressed) const
+        {
+            // each compressed draw holds a uint32_t size followed by the 5 entropy coded streams of compressBrick(), each at least a byte long,
+            // padded to at least numPoints / maxPointsPerCompressedByte bytes
+            if (compressed) return sizeof(uint32_t) + std::max<uint64_t>(5, numPoints / maxPointsPerCompressedByte);
+            return static_cast<uint64_t>(numPoints) * (vertexSize(bits) + sizeof(vsg::ubvec4));
+        }
+
+        bool read(vsg::dsphere& bound)
+        {
+            return read(bound.center.x) && read(bound.center.y) && read(bound.center.z) && read(bound.radius);
+        }
+
+        bool decode(vsg::ref_ptr<vsg::Node>& node, uint32_t depth = 0)
+        {
+            NodeType type;
+            if (depth > maxNodeDepth || !read(type)) return false;
+
+            switch (type)
+            {
+            case (NODE_NULL):
+                node = {};
+                return true;
+            case (NODE_EMPTY):
+                node = vsg::Node::create();
+                return true;
+            case (NODE_GROUP): {
+                uint32_t numChildren = 0;
+                if (!read(numChildren) || !available(numChildren * sizeof(NodeType))) return false;
+
+                auto group = vsg::Group::create(numChildren);
+                for (auto& child : group->children)
+                {
+                    if (!decode(child, depth + 1)) return false;
+                }
+                node = group;
+                return true;
+            }
+            case (NODE_CULLNODE): {
+                auto cullNode = vsg::CullNode::create();
+                if (!read(cullNode->bound) || !decode(cullNode->child, depth + 1)) return false;
+                node = cullNode;
+                return true;
+            }
+            case (NODE_LOD): {
+                auto lod = vsg::LOD::create();
+                uint32_t numChildren = 0;
+                if (!read(lod->bound) || !read(numChildren) || !available(numChildren * (sizeof(double) + sizeof(NodeType)))) return false;
+                for (uint32_t i = 0; i < numChildren; ++i)
+                {
+                    vsg::LOD::Child child;
+                    if (!read(child.minimumScreenHeightRatio) || !decode(child.node, depth + 1)) return false;
+                    lod->addChild(child);
+                }
+                node = lod;
+                return true;
+            }
+            case (NODE_PAGEDLOD): {
+                auto plod = vsg::PagedLOD::create();
+                uint32_t length = 0;
+                if (!read(plod->bound) || !read(plod->children[0].minimumScreenHeightRatio) || !read(length)) return false;
+                if (!available(length)) return false;
+
+                plod->filename = std::string(reinterpret_cast<const char*>(ptr), length);
+                ptr += length;
+
+                plod->children[1].minimumScreenHeightRatio = 0.0;
+                if (!decode(plod->children[1].node, depth + 1)) return false;
+
+                // the DatabasePager reads the external child using the PagedLOD's options
+                plod->options = options;
+                node = plod;
+                return true;
+            }
+            case (NODE_BRICK):
+                return decodeBrick(node, false);
+            case (NODE_COMPRESSED_BRICK):
+                return decodeBrick(node, true);
+            case (NODE_PACKED):
+                return decodePacked(node, false, false);
+            case (NODE_COMPRESSED_PACKED):
+                return decodePacked(node, true, false);
+            case (NODE_PACKED_INDIRECT):
+                return decodePacked(node, false, true);
+            case (NODE_COMPRESSED_PACKED_INDIRECT):
+                return decodePacked(node, true, true);
+            default:
+                return false;
+            }
+        }
+
+        bool decodeBrick(vsg::ref_ptr<vsg::Node>& node, bool compressed)
+        {
+            uint8_t bits = 0;
+            uint32_t numPoints = 0;
+            vsg::vec4 positionScale;
+            vsg::vec2 pointSize;
+            if (!read(bits) || !read(numPoints) || !read(positionScale) || !read(pointSize)) return false;
+            if (!available(minimumPointsSize(bits, numPoints, compressed))) return false;
+
+            auto vertices = createVertices(bits, numPoints);
+            if (!vertices) return false;
+
+            auto colors = vsg::ubvec4Array::create(numPoints, vsg::Data::Properties(VK_FORMAT_R8G8B8A8_UNORM));
+            if (!readPoints(bits, numPoints, vertices->dataPointer(), colors->data(), compressed)) return false;
+
+            auto positionScaleValue = vsg::vec4Value::create(positionScale);
+            auto pointSizeValue = vsg::vec2Value::create(pointSize);
+            positionScaleValue->properties.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+            pointSizeValue->properties.format = VK_FORMAT_R32G32_SFLOAT;
+            share(pointSizeValue);
+
+            auto vertexDraw = vsg::VertexDraw::create();
+            vertexDraw->assignArrays({vertices, normals, colors, positionScaleValue, pointSizeValue});
+            vertexDraw->vertexCount = numPoints;
+            vertexDraw->instanceCount = 1;
+
+            node = vertexDraw;
+            return true;
+        }
+
+        bool decodePacked(vsg::ref_ptr<vsg::Node>& node, bool compressed, bool indirect)
+        {
+            uint8_t bits = 0;
+            uint32_t numDraws = 0;
+            if (!read(bits) || !read(numDraws) || !available(static_cast<uint64_t>(numDraws) * (sizeof(uint32_t) + sizeof(vsg::vec4) + sizeof(vsg::vec2)))) return false;
+
+            auto normalsArray = vsg::vec3Array::create(numDraws, vsg::vec3(0.0f, 0.0f, 1.0f), vsg::Data::Properties(VK_FORMAT_R32G32B32_SFLOAT));
+            share(normalsArray);
+            auto positionScales = vsg::vec4Array::create(numDraws, vsg::Data::Properties(VK_FORMAT_R32G32B32A32_SFLOAT));
+            auto pointSizes = vsg::vec2Array::create(numDraws, vsg::Data::Properties(VK_FORMAT_R32G32_SFLOAT));
+
+            std::vector<uint32_t> counts(numDraws);
+            uint64_t numPoints = 0;
+            uint64_t minimumSize = 0;
+            for (uint32_t i = 0; i < numDraws; ++i)
+            {
+                if (!read(counts[i]) || !read(positionScales->at(i)) || !read(pointSizes->at(i))) return false;
+                numPoints += counts[i];
+                minimumSize += minimumPointsSize(bits, counts[i], compressed);
+            }
+            if (numPoints > std::numeric_limits<uint32_t>::max() || !available(minimumSize)) return false;
+
+            auto vertices = createVertices(bits, static_cast<uint32_t>(numPoints));
+            if (!vertices) return false;
+
+            auto colors = vsg::ubvec4Array::create(static_cast<uint32_t>(numPoints), vsg::Data::Properties(VK_FORMAT_R8G8B8A8_UNORM));
+
+            auto drawCommands = vsg::DrawIndirectCommandArray::create(numDraws);
+            uint32_t first = 0;
+            for (uint32_t i = 0; i < numDraws; ++i)
+            {
+                auto vertexData = static_cast<uint8_t*>(vertices->dataPointer()) + first * vertexSize(bits);
+                if (!readPoints(bits, counts[i], vertexData, colors->data() + first, compressed)) return false;
+
+                drawCommands->set(i, vsg::DrawIndirectCommand{counts[i], 1, first, i});
+                first += counts[i];
+            }
+
+            auto commands = vsg::Commands::create();
+            commands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, normalsArray, colors, positionScales, pointSizes}));
+            if (indirect)
+            {
+                commands->addChild(vsg::DrawIndirect::create(drawCommands, numDraws, static_cast<uint32_t>(sizeof(vsg::DrawIndirectCommand))));
+            }
+            else
+            {
+                for (auto& dc : *drawCommands) commands->addChild(vsg::Draw::create(dc.vertexCount, dc.instanceCount, dc.firstVertex, dc.firstInstance));
+            }
+
+            node = commands;
+            return true;
+        }
+
+        bool readPoints(uint8_t bits, uint32_t numPoints, void* vertexData, vsg::ubvec4* colorData, bool compressed)
+        {
+            if (compressed)
+            {
+                uint32_t compressedSize = 0;
+                if (!read(compressedSize) || !available(compressedSize) || compressedSize < numPoints / maxPointsPerCompressedByte) return false;
+
+                const uint8_t* compressedEnd = ptr + compressedSize;
+                if (!decompressBrick(ptr, compressedEnd, bits, numPoints, vertexData, colorData)) return false;
+                ptr = compressedEnd;
+                return true;
+            }
+
+            return read(vertexData, numPoints * vertexSize(bits)) && read(colorData, numPoints * sizeof(vsg::ubvec4));
+        }
+    };
+} // namespace
+
+PointsTile::PointsTile() :
+    supportedExtensions{tileExtension()}
+{
+}
+
+vsg::ref_ptr<vsg::Object> PointsTile::read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const
+{
+    if (!vsg::compatibleExtension(filename, options, supportedExtensions)) return {};
+
+    auto found_filename = vsg::findFile(filename, options);
+    if (!found_filename) return {};
+
+    auto mappedFile = MappedFile::create(found_filename);
+    if (!mappedFile->valid()) return {};
+
+    // the PagedLOD filenames within the tile are relative to the tile's directory
+    auto local_options = options ? vsg::Options::create(*options) : vsg::Options::create();
+    auto tilePath = vsg::filePath(found_filename);
+    if (tilePath) local_options->paths.insert(local_options->paths.begin(), tilePath);
+
+    return read(mappedFile->data(), mappedFile->size(), local_options);
+}
+
+vsg::ref_ptr<vsg::Object> PointsTile::read(const uint8_t* ptr, size_t size, vsg::ref_ptr<const vsg::Options> options) const
+{
+    if (size < sizeof(tileMagic) + sizeof(uint32_t) || std::memcmp(ptr, tileMagic, sizeof(tileMagic)) != 0) return {};
+
+    Decoder decoder{ptr + sizeof(tileMagic), ptr + size, options, vsg::vec3Value::create(vsg::vec3(0.0f, 0.0f, 1.0f))};
+    decoder.normals->properties.format = VK_FORMAT_R32G32B32_SFLOAT;
+    decoder.share(decoder.normals);
+
+    uint32_t version = 0;
+    if (!decoder.read(version) || version < 1 || version > tileVersion)
+    {
+        vsg::warn("PointsTile: unsupported tile version ", version);
+        return {};
+    }
+
+    vsg::ref_ptr<vsg::Node> node;
+    if (!decoder.decode(node))
+    {
+        vsg::warn("PointsTile: corrupt tile.");
+        return {};
+    }
+
+    return node;
+}
+
+bool PointsTile::write(const vsg::Object* object, const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const
+{
+    if (!vsg::compatibleExtension(filename, options, supportedExtensions)) return false;
+
+    std::ofstream fout(filename, std::ios::out | std::ios::binary);
+    if (!fout) return false;
+
+    return write(object, fout, options);
+}
+
+bool PointsTile::write(const vsg::Object* object, std::ostream& fout, vsg::ref_ptr<const vsg::Options>) const
+{
+    auto node = object ? object->cast<vsg::Node>() : nullptr;
+    if (!node) return false;
+
+    Encoder encoder{fout, compress};
+    encoder.write(tileMagic, sizeof(tileMagic));
+    encoder.write(tileVersion);
+
+    return encoder.encode(node) && fout.good();
+}
@@ -0,0 +1,263 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/PointsTile.h>
+#include <vsgPoints/TileArchive.h>
+
+#include <vsg/io/FileSystem.h>
+#include <vsg/io/Logger.h>
+#include <vsg/io/Options.h>
+#include <vsg/io/VSG.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+using namespace vsgPoints;
+
+namespace
+{
+    const char archiveMagic[8] = {'v', 's', 'g', 'P', 'T', 'A', 'R', 'C'};
+    const uint32_t archiveVersion = 1;
+    const size_t headerSize = sizeof(archiveMagic) + sizeof(uint32_t);
+    const size_t footerSize = sizeof(uint64_t) + sizeof(archiveMagic);
+
+    template<typename T>
+    void writeValue(std::ostream& out, T value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool readValue(const uint8_t*& ptr, const uint8_t* end, T& value)
+    {
+        if (static_cast<size_t>(end - ptr) < sizeof(T)) return false;
+        std::memcpy(&value, ptr, sizeof(T));
+        ptr += sizeof(T);
+        return true;
+    }
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TileArchiveWriter
+//
+TileArchiveWriter::TileArchiveWriter(const vsg::Path& in_filename, const vsg::Path& in_extension, vsg::ref_ptr<const vsg::ReaderWriter> in_writer) :
+    filename(in_filename),
+    extension(in_extension),
+    writer(in_writer),
+    _staging(stagingFilename(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc)
+{
+    if (!writer)
+    {
+        if (extension == PointsTile::tileExtension())
+        {
+            writer = PointsTile::create();
+        }
+        else
+        {
+            writer = vsg::VSG::create();
+        }
+    }
+
+    _options = vsg::Options::create();
+    _options->extensionHint = extension;
+}
+
+TileArchiveWriter::~TileArchiveWriter()
+{
+    if (_staging.is_open()) close();
+}
+
+bool TileArchiveWriter::add(const std::string& tile, const vsg::Object* object)
+{
+    // serialize outside the lock so that concurrent callers only contend on the append
+    std::ostringstream buffer(std::ios::out | std::ios::binary);
+    if (!writer->write(object, buffer, _options))
+    {
+        vsg::warn("TileArchiveWriter::add(", tile, ") unable to serialize tile with extension ", extension);
+
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _failed = true;
+        return false;
+    }
+    auto data = buffer.str();
+
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    // the entry holds the tile's offset within the staging file until close() copies it into the archive
+    TileArchiveEntry entry;
+    entry.offset = static_cast<uint64_t>(_staging.tellp());
+    entry.size = data.size();
+
+    _staging.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!_staging.good())
+    {
+        _failed = true;
+        return false;
+    }
+
+    _index[tile] = entry;
+    return true;
+}
+
+vsg::Path TileArchiveWriter::tileFilename(const std::string& tile, bool root) const
+{
+    vsg::Path archive = root ? filename : vsg::filename(filename);
+    return vsg::Path(archive.string() + "/" + tile);
+}
+
+bool TileArchiveWriter::close()
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+    if (!_staging.is_open()) return false;
+
+    std::ofstream fout(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    fout.write(archiveMagic, sizeof(archiveMagic));
+    writeValue(fout, archiveVersion);
+
+    // copy the tiles from the staging file in name order, so the archive is the same however the concurrent add() calls were ordered
+    std::vector<char> buffer(1 << 20);
+    for (auto& [name, entry] : _index)
+    {
+        _staging.seekg(static_cast<std::streamoff>(entry.offset));
+        entry.offset = static_cast<uint64_t>(fout.tellp());
+        for (uint64_t remaining = entry.size; remaining > 0 && _staging.good() && fout.good();)
+        {
+            auto count = static_cast<std::streamsize>(std::min(remaining, static_cast<uint64_t>(buffer.size())));
+            _staging.read(buffer.data(), count);
+            fout.write(buffer.data(), count);
+            remaining -= static_cast<uint64_t>(count);
+        }
+    }
+
+    bool copied = _staging.good();
+    _staging.close();
+    std::remove(stagingFilename().string().c_str());
+
+    uint64_t indexOffset = static_cast<uint64_t>(fout.tellp());
+    writeValue(fout, static_cast<uint64_t>(_index.size()));
+    for (auto& [name, entry] : _index)
+    {
+        writeValue(fout, static_cast<uint32_t>(name.size()));
+        fout.write(name.data(), static_cast<std::streamsize>(name.size()));
+        writeValue(fout, entry.offset);
+        writeValue(fout, entry.size);
+    }
+
+    writeValue(fout, indexOffset);
+    fout.write(archiveMagic, sizeof(archiveMagic));
+
+    bool result = copied && fout.good() && !_failed;
+    fout.close();
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// TileArchive
+//
+TileArchive::TileArchive()
+{
+}
+
+vsg::ref_ptr<TileArchive::Archive> TileArchive::_open(const vsg::Path& filename) const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (auto itr = _archives.find(filename); itr != _archives.end()) return itr->second;
+
+    // tiles are paged in by view position so hint random access rather than sequential
+    auto mappedFile = MappedFile::create(filename, false);
+    if (!mappedFile->valid() || mappedFile->size() < headerSize + footerSize || std::memcmp(mappedFile->data(), archiveMagic, sizeof(archiveMagic)) != 0)
+    {
+        vsg::warn("TileArchive: ", filename, " is not a valid tile archive.");
+        return {};
+    }
+
+    auto end = mappedFile->end();
+    auto ptr = end - footerSize;
+
+    uint64_t indexOffset = 0;
+    readValue(ptr, end, indexOffset);
+    if (std::memcmp(ptr, archiveMagic, sizeof(archiveMagic)) != 0 || indexOffset < headerSize || indexOffset > mappedFile->size() - footerSize)
+    {
+        vsg::warn("TileArchive: ", filename, " has an invalid footer, archive may be incomplete.");
+        return {};
+    }
+
+    auto archive = Archive::create();
+    archive->mappedFile = mappedFile;
+
+    ptr = mappedFile->data() + indexOffset;
+    end = mappedFile->end() - footerSize;
+
+    uint64_t numTiles = 0;
+    bool valid = readValue(ptr, end, numTiles);
+    for (uint64_t i = 0; valid && i < numTiles; ++i)
+    {
+        uint32_t nameLength = 0;
+        valid = readValue(ptr, end, nameLength) && static_cast<size_t>(end - ptr) >= nameLength;
+        if (!valid) break;
+
+        std::string name(reinterpret_cast<const char*>(ptr), nameLength);
+        ptr += nameLength;
+
+        TileArchiveEntry entry;
+        // compare without summing offset and size, which a corrupt entry could overflow past the check
+        valid = readValue(ptr, end, entry.offset) && readValue(ptr, end, entry.size) && entry.size <= indexOffset && entry.offset <= indexOffset - entry.size;
+        if (valid) archive->index[name] = entry;
+    }
+
+    if (!valid)
+    {
+        vsg::warn("TileArchive: ", filename, " has a corrupt index.");
+        return {};
+    }
+
+    _archives[filename] = archive;
+    return archive;
+}
+
+vsg::ref_ptr<vsg::Object> TileArchive::read(const vsg::Path& filename, vsg::ref_ptr<const vsg::Options> options) const
+{
+    // split filename into the archive path and the name of the tile within it
+    const std::string& str = filename.string();
+    std::string archiveExt(archiveExtension());
+    auto pos = str.find(archiveExt + "/");
+    if (pos == std::string::npos) return {};
+
+    vsg::Path archiveFilename(str.substr(0, pos + archiveExt.size()));
+    std::string tile = str.substr(pos + archiveExt.size() + 1);
+
+    auto found_filename = vsg::findFile(archiveFilename, options);
+    if (!found_filename) return {};
+
+    auto archive = _open(found_filename);
+    if (!archive) return {};
+
+    auto itr = archive->index.find(tile);
+    if (itr == archive->index.end()) return {};
+
+    // tiles refer to their children relative to the archive's directory, so make sure it's searched when those are loaded
+    auto local_options = options ? vsg::Options::create(*options) : vsg::Options::create();
+    auto archivePath = vsg::filePath(found_filename);
+    if (archivePath && (local_options->paths.empty() || local_options->paths.front() != archivePath)) local_options->paths.insert(local_options->paths.begin(), archivePath);
+    local_options->extensionHint = vsg::fileExtension(tile);
+
+    auto ptr = archive->mappedFile->data() + itr->second.offset;
+    auto size = static_cast<size_t>(itr->second.size);
+    if (local_options->extensionHint == PointsTile::tileExtension()) return PointsTile().read(ptr, size, local_options);
+    return vsg::VSG().read(ptr, size, local_options);
+}
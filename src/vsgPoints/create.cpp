@@ -11,11 +11,16 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 </editor-fold> */
 
 #include <vsgPoints/BrickShaderSet.h>
+#include <vsgPoints/PointsTile.h>
+#include <vsgPoints/TileArchive.h>
 #include <vsgPoints/create.h>
+#include <vsgPoints/parallel.h>
 
 #include <vsg/io/Logger.h>
+#include <vsg/io/read.h>
 #include <vsg/io/write.h>
 #include <vsg/nodes/CullGroup.h>
+#include <vsg/nodes/CullNode.h>
 #include <vsg/nodes/LOD.h>
 #include <vsg/nodes/MatrixTransform.h>
 #include <vsg/nodes/PagedLOD.h>
@@ -24,11 +29,76 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include <vsg/state/ViewDependentState.h>
 #include <vsg/state/material.h>
 #include <vsg/utils/GraphicsPipelineConfigurator.h>
+#include <vsg/utils/SharedObjects.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <mutex>
 
 using namespace vsgPoints;
 
+namespace
+{
+    // spill bricks until the points held in memory across all the levels fit within settings.memoryBudget, starting with the finest levels
+    void spillLevels(Levels& levels, const Settings& settings)
+    {
+        size_t total = 0;
+        for (auto& level : levels) total += level->memoryUsed();
+
+        for (auto& level : levels)
+        {
+            if (total <= settings.memoryBudget) break;
+
+            size_t used = level->memoryUsed();
+            level->spill(settings, used - std::min(used, total - settings.memoryBudget));
+            total -= used - level->memoryUsed();
+        }
+    }
+
+    // create the nodes for sibling leaf bricks along with their bounds, packing the bricks holding fewer than settings.packThreshold points, or all of them
+    // with settings.drawIndirect, into a single node that takes the slot of the first packed brick, leaving the slots of the other packed bricks null.
+    std::vector<std::pair<vsg::ref_ptr<vsg::Node>, vsg::dbox>> createLeafNodes(const Settings& settings, const Bricks::SortedBricks& leaves)
+    {
+        std::vector<std::pair<vsg::ref_ptr<vsg::Node>, vsg::dbox>> nodes(leaves.size());
+
+        Bricks::SortedBricks packed;
+        size_t packedSlot = 0;
+        for (size_t i = 0; i < leaves.size(); ++i)
+        {
+            auto& [key, brick] = leaves[i];
+            if (settings.drawIndirect || brick->size() + brick->numSpilled() < settings.packThreshold)
+            {
+                if (packed.empty()) packedSlot = i;
+                packed.push_back(leaves[i]);
+            }
+            else
+            {
+                nodes[i].first = brick->createRendering(settings, key, nodes[i].second);
+            }
+        }
+
+        if (packed.size() == 1)
+        {
+            nodes[packedSlot].first = packed.front().second->createRendering(settings, packed.front().first, nodes[packedSlot].second);
+        }
+        else if (packed.size() > 1)
+        {
+            nodes[packedSlot].first = Brick::createPackedRendering(settings, packed, nodes[packedSlot].second);
+        }
+
+        // the nodes now hold the points and the bricks won't be visited again, so with a memory budget let them go along with the tile
+        if (settings.memoryBudget > 0 && settings.createType == CREATE_PAGEDLOD)
+        {
+            for (auto& leaf : leaves) leaf.second->clear();
+        }
+
+        return nodes;
+    }
+} // namespace
+
 vsg::ref_ptr<vsg::Node> vsgPoints::createSceneGraph(vsg::ref_ptr<vsgPoints::Bricks> bricks, vsg::ref_ptr<vsgPoints::Settings> settings)
 {
     if (bricks->empty())
@@ -56,15 +126,82 @@ vsg::ref_ptr<vsg::Node> vsgPoints::createSceneGraph(vsg::ref_ptr<vsgPoints::Bric
         auto group = vsgPoints::createStateGroup(*settings);
         transform->addChild(group);
 
-        vsg::dbox bound;
+        vsg::t_box<int32_t> keyBounds;
         for (auto& [key, brick] : *bricks)
         {
-            if (auto node = brick->createRendering(*(bricks->settings), key, bound))
+            keyBounds.add(key.x, key.y, key.z);
+        }
+
+        // each brick gets a CullNode with its own bound, then the bricks are grouped into an octree of CullGroups over their keys,
+        // translated so they are positive and halving them converges on a single root, so bricks outside the view are culled hierarchically.
+        struct Cell
+        {
+            vsg::ref_ptr<vsg::Node> node;
+            vsg::dbox bound;
+        };
+
+        auto cullNode = [](vsg::ref_ptr<vsg::Node> child, const vsg::dbox& child_bound) {
+            auto node = vsg::CullNode::create();
+            node->bound.center = (child_bound.min + child_bound.max) * 0.5;
+            node->bound.radius = vsg::length(child_bound.max - child_bound.min) * 0.5;
+            node->child = child;
+            return node;
+        };
+
+        auto cellKey = [&](const Key& key) { return Key{key.x - keyBounds.min.x, key.y - keyBounds.min.y, key.z - keyBounds.min.z, key.w}; };
+
+        // sibling bricks are created together so that those with few points can be packed into a single node
+        std::map<Key, Bricks::SortedBricks> siblings;
+        for (auto& [key, brick] : bricks->sorted())
+        {
+            auto cell_key = cellKey(key);
+            siblings[Key{cell_key.x / 2, cell_key.y / 2, cell_key.z / 2, cell_key.w * 2}].emplace_back(key, brick);
+        }
+
+        std::map<Key, Cell> cells;
+        for (auto& [parent_key, leaves] : siblings)
+        {
+            auto leafNodes = createLeafNodes(*(bricks->settings), leaves);
+            for (size_t i = 0; i < leaves.size(); ++i)
             {
-                group->addChild(node);
+                auto& [node, bound] = leafNodes[i];
+                if (node) cells[cellKey(leaves[i].first)] = Cell{cullNode(node, bound), bound};
             }
         }
 
+        while (cells.size() > 1)
+        {
+            std::map<Key, std::vector<Cell>> parents;
+            for (auto& [key, cell] : cells)
+            {
+                parents[Key{key.x / 2, key.y / 2, key.z / 2, key.w * 2}].push_back(cell);
+            }
+
+            cells.clear();
+            for (auto& [key, children] : parents)
+            {
+                // cells with a single child are passed up as is rather than adding another level of culling
+                if (children.size() == 1)
+                {
+                    cells[key] = children.front();
+                    continue;
+                }
+
+                auto& cell = cells[key];
+                auto childGroup = vsg::CullGroup::create();
+                for (auto& child : children)
+                {
+                    cell.bound.add(child.bound);
+                    childGroup->addChild(child.node);
+                }
+                childGroup->bound.center = (cell.bound.min + cell.bound.max) * 0.5;
+                childGroup->bound.radius = vsg::length(cell.bound.max - cell.bound.min) * 0.5;
+                cell.node = childGroup;
+            }
+        }
+
+        if (!cells.empty()) group->addChild(cells.begin()->second.node);
+
         return cullGroup;
     }
     else
@@ -84,6 +221,10 @@ vsg::ref_ptr<vsg::Node> vsgPoints::createSceneGraph(vsg::ref_ptr<vsgPoints::Bric
             (*translated_bricks)[Key{key.x - key_origin.x, key.y - key_origin.y, key.z - key_origin.z, key.w}] = brick;
         }
 
+        // streamed builds consume the bricks, so release the caller's references to them so each subtree can be freed once written
+        bool streamed = settings->createType == CREATE_PAGEDLOD && settings->subtreeLevels > 0;
+        if (streamed) bricks->clear();
+
         bricks = translated_bricks;
 
         double brickPrecision = settings->precision;
@@ -97,9 +238,40 @@ vsg::ref_ptr<vsg::Node> vsgPoints::createSceneGraph(vsg::ref_ptr<vsgPoints::Bric
 
         transform->matrix = vsg::translate(offset);
 
+        if (settings->compressTiles && settings->createType == CREATE_PAGEDLOD && settings->extension != PointsTile::tileExtension())
+        {
+            vsg::warn("createSceneGraph() compressTiles is only supported with the ", PointsTile::tileExtension(), " extension, tiles will not be compressed.");
+        }
+
+        vsg::ref_ptr<BrickStore> store;
+        if (settings->storeBricks && settings->createType == CREATE_PAGEDLOD)
+        {
+            if (settings->additive || settings->archiveTiles)
+            {
+                vsg::warn("createSceneGraph() storeBricks is not supported with additive or archiveTiles, bricks will not be stored.");
+            }
+            else
+            {
+                store = BrickStore::create(vsg::make_string(settings->path, BrickStore::storeExtension()));
+                store->assign(*settings, key_origin);
+            }
+        }
+
+        if (streamed)
+        {
+            if (auto model = createPagedLODStreamed(*bricks, *settings, store))
+            {
+                transform->addChild(model);
+            }
+            if (store && !store->writeManifest()) return {};
+            return transform;
+        }
+
         vsgPoints::Levels levels;
         levels.push_back(bricks);
 
+        if (settings->memoryBudget > 0) spillLevels(levels, *settings);
+
         while (levels.back()->size() > 1)
         {
             auto& source = levels.back();
@@ -107,54 +279,260 @@ vsg::ref_ptr<vsg::Node> vsgPoints::createSceneGraph(vsg::ref_ptr<vsgPoints::Bric
             levels.push_back(vsgPoints::Bricks::create());
             auto& destination = levels.back();
 
-            if (!vsgPoints::generateLevel(*source, *destination, *settings)) break;
+            // the source holds more than one brick so the destination can only be empty if spilled points couldn't be restored
+            if (!vsgPoints::generateLevel(*source, *destination, *settings)) return {};
+
+            if (settings->memoryBudget > 0) spillLevels(levels, *settings);
         }
 
         vsg::debug("levels = ", levels.size());
 
+        // store the bricks before createPagedLOD() as creating the tiles reorders them, and releases them when there is a memory budget
+        if (store && !store->add(levels, *settings)) return {};
+
         if (auto model = createPagedLOD(levels, *settings))
         {
             transform->addChild(model);
         }
 
+        if (store && !store->writeManifest()) return {};
+
         return transform;
     }
 }
 
+namespace
+{
+    std::mutex s_makeDirectoryMutex;
+
+    // ReaderWriter to write tiles with, or null to use vsg::write()
+    vsg::ref_ptr<vsg::ReaderWriter> createTileWriter(const Settings& settings)
+    {
+        if (settings.extension != PointsTile::tileExtension()) return {};
+
+        auto pointsTile = PointsTile::create();
+        pointsTile->compress = settings.compressTiles;
+        return pointsTile;
+    }
+
+    // open an archive for the tiles alongside settings.path, returning null if it can't be opened
+    vsg::ref_ptr<TileArchiveWriter> openTileArchive(const Settings& settings)
+    {
+        auto archive = TileArchiveWriter::create(vsg::make_string(settings.path, TileArchive::archiveExtension()), settings.extension, createTileWriter(settings));
+        if (!archive->valid())
+        {
+            vsg::warn("unable to open tile archive ", archive->filename);
+            return {};
+        }
+        return archive;
+    }
+
+    // write the archive's index, returning false if it or any of the tiles added to it failed to write
+    bool closeTileArchive(TileArchiveWriter& archive)
+    {
+        if (!archive.close())
+        {
+            vsg::warn("unable to write tile archive ", archive.filename);
+            return false;
+        }
+        return true;
+    }
+
+    // reduce the points to one per voxel, the points are sorted by voxel so the result is spatially coherent as well
+    void decimateToVoxels(std::vector<vsgPoints::PackedPoint>& points, bool averageColors)
+    {
+        auto voxel = [](const vsgPoints::PackedPoint& p) { return (static_cast<uint64_t>(p.v.x) << 32) | (static_cast<uint64_t>(p.v.y) << 16) | static_cast<uint64_t>(p.v.z); };
+        std::stable_sort(points.begin(), points.end(), [&](const vsgPoints::PackedPoint& lhs, const vsgPoints::PackedPoint& rhs) { return voxel(lhs) < voxel(rhs); });
+
+        size_t numVoxels = 0;
+        for (size_t i = 0; i < points.size();)
+        {
+            size_t end = i + 1;
+            uint64_t current = voxel(points[i]);
+            while (end < points.size() && voxel(points[end]) == current) ++end;
+
+            vsgPoints::PackedPoint representative = points[i];
+            if (averageColors && (end - i) > 1)
+            {
+                uint32_t count = static_cast<uint32_t>(end - i);
+                uint32_t r = count / 2, g = count / 2, b = count / 2, a = count / 2;
+                for (size_t j = i; j < end; ++j)
+                {
+                    auto c = points[j].c;
+                    r += c.r, g += c.g, b += c.b, a += c.a;
+                }
+                representative.c.set(static_cast<uint8_t>(r / count), static_cast<uint8_t>(g / count), static_cast<uint8_t>(b / count), static_cast<uint8_t>(a / count));
+            }
+
+            points[numVoxels++] = representative;
+            i = end;
+        }
+        points.resize(numVoxels);
+    }
+} // namespace
+
 bool vsgPoints::generateLevel(vsgPoints::Bricks& source, vsgPoints::Bricks& destination, const vsgPoints::Settings& settings)
 {
     int32_t bits = settings.bits;
-    for (auto& [source_key, source_brick] : source)
+
+    // group the source bricks by the destination brick they contribute to, keeping the children of each destination in key order.
+    // Keys are halved with an arithmetic shift so negative keys round towards negative infinity, matching the children key * 2 + (0 or 1)
+    // of each parent, as integer division would map keys -1, 0 and 1 all to 0.
+    auto sourceBricks = source.sorted();
+
+    std::vector<std::pair<vsgPoints::Key, size_t>> destinationKeys;
+    destinationKeys.reserve(sourceBricks.size());
+    for (size_t i = 0; i < sourceBricks.size(); ++i)
     {
-        vsgPoints::Key destination_key = {source_key.x / 2, source_key.y / 2, source_key.z / 2, source_key.w * 2};
-        vsg::ivec3 offset = {(source_key.x & 1) << bits, (source_key.y & 1) << bits, (source_key.z & 1) << bits};
+        auto& source_key = sourceBricks[i].first;
+        destinationKeys.emplace_back(vsgPoints::Key{source_key.x >> 1, source_key.y >> 1, source_key.z >> 1, source_key.w * 2}, i);
+    }
+    std::stable_sort(destinationKeys.begin(), destinationKeys.end(), [](const std::pair<vsgPoints::Key, size_t>& lhs, const std::pair<vsgPoints::Key, size_t>& rhs) { return lhs.first < rhs.first; });
+
+    // create the destination bricks up front so the worker threads never modify the destination BrickMap
+    struct DestinationGroup
+    {
+        vsgPoints::Brick* brick;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<DestinationGroup> groups;
+    destination.reserve(destination.size() + destinationKeys.size() / 4);
+    for (size_t i = 0; i < destinationKeys.size();)
+    {
+        size_t end = i + 1;
+        while (end < destinationKeys.size() && destinationKeys[end].first == destinationKeys[i].first) ++end;
+
+        auto& destination_brick = destination[destinationKeys[i].first];
+        if (!destination_brick) destination_brick = vsgPoints::Brick::create(settings.bits);
+
+        groups.push_back(DestinationGroup{destination_brick.get(), i, end});
+        i = end;
+    }
+
+    // when decimating to voxels all the source points are gathered and then reduced to one per voxel of the destination brick
+    size_t stride = (settings.decimation == DECIMATE_STRIDE) ? 4 : 1;
+
+    // in additive mode the promoted points are removed from the children so can't then be merged into voxels without being lost,
+    // so a quarter of each child's points are always promoted to match the density of the stride decimation
+    const size_t additiveStride = 4;
+
+    std::atomic<bool> restoreFailed{false};
+
+    // each destination brick is filled by a single task from its up to 8 source bricks, so no locking is required
+    auto fillDestination = [&](const DestinationGroup& group) {
+        // spilled source bricks are read back for the duration of the task, then spilled again so only the bricks being worked on are held in memory
+        std::vector<bool> respill(group.end - group.begin, false);
+        bool restored = true;
+        for (size_t i = group.begin; i < group.end; ++i)
+        {
+            auto& source_brick = sourceBricks[destinationKeys[i].second].second;
+            respill[i - group.begin] = source_brick->numSpilled() > 0;
+            if (!source_brick->restore()) restored = false;
+        }
 
-        auto& destination_brick = destination[destination_key];
-        if (!destination_brick) destination_brick = vsgPoints::Brick::create();
+        auto respillSources = [&]() {
+            for (size_t i = group.begin; i < group.end; ++i)
+            {
+                if (respill[i - group.begin]) sourceBricks[destinationKeys[i].second].second->spill();
+            }
+        };
+
+        if (!restored)
+        {
+            restoreFailed = true;
+            respillSources();
+            return;
+        }
 
-        auto& source_points = source_brick->points;
-        auto& destination_points = destination_brick->points;
-        size_t count = source_points.size();
-        for (size_t i = 0; i < count; i += 4)
+        // gather the destination points in a working buffer so the brick's arrays can be allocated at their final size
+        std::vector<vsgPoints::PackedPoint> destination_points;
+        for (size_t i = group.begin; i < group.end; ++i)
         {
-            auto& p = source_points[i];
+            auto& [source_key, source_brick] = sourceBricks[destinationKeys[i].second];
+            vsg::ivec3 offset = {(source_key.x & 1) << bits, (source_key.y & 1) << bits, (source_key.z & 1) << bits};
+
+            size_t count = source_brick->size();
 
-            vsgPoints::PackedPoint new_p;
-            new_p.v.x = static_cast<uint16_t>((static_cast<int32_t>(p.v.x) + offset.x) / 2);
-            new_p.v.y = static_cast<uint16_t>((static_cast<int32_t>(p.v.y) + offset.y) / 2);
-            new_p.v.z = static_cast<uint16_t>((static_cast<int32_t>(p.v.z) + offset.z) / 2);
-            new_p.c = p.c;
+            if (settings.additive)
+            {
+                // promote every additiveStride-th point, quantized to the parent as in the non additive case, so shifting it by up to one
+                // unit of the child's precision, with the promoted points removed from the child so each point is stored and drawn just once.
+                size_t numKept = 0;
+                for (size_t j = 0; j < count; ++j)
+                {
+                    auto p = source_brick->point(j);
+                    if ((j % additiveStride) == 0)
+                    {
+                        vsgPoints::PackedPoint new_p;
+                        new_p.v.x = static_cast<uint16_t>((static_cast<int32_t>(p.v.x) + offset.x) / 2);
+                        new_p.v.y = static_cast<uint16_t>((static_cast<int32_t>(p.v.y) + offset.y) / 2);
+                        new_p.v.z = static_cast<uint16_t>((static_cast<int32_t>(p.v.z) + offset.z) / 2);
+                        new_p.c = p.c;
+
+                        destination_points.push_back(new_p);
+                    }
+                    else
+                    {
+                        source_brick->set(numKept++, p);
+                    }
+                }
+                source_brick->resize(numKept);
+                source_brick->computeVertexBound();
+                continue;
+            }
+
+            for (size_t j = 0; j < count; j += stride)
+            {
+                auto p = source_brick->point(j);
 
-            destination_points.push_back(new_p);
+                vsgPoints::PackedPoint new_p;
+                new_p.v.x = static_cast<uint16_t>((static_cast<int32_t>(p.v.x) + offset.x) / 2);
+                new_p.v.y = static_cast<uint16_t>((static_cast<int32_t>(p.v.y) + offset.y) / 2);
+                new_p.v.z = static_cast<uint16_t>((static_cast<int32_t>(p.v.z) + offset.z) / 2);
+                new_p.c = p.c;
+
+                destination_points.push_back(new_p);
+            }
         }
+
+        if (settings.decimation != DECIMATE_STRIDE && !settings.additive) decimateToVoxels(destination_points, settings.decimation == DECIMATE_VOXEL_AVERAGE);
+
+        group.brick->reserve(group.brick->size() + destination_points.size());
+        for (auto& p : destination_points) group.brick->add(p);
+
+        respillSources();
+    };
+
+    size_t numTasks = std::min(groups.size(), concurrency(settings) * 16);
+    parallel_for(settings, numTasks, [&](size_t task) {
+        size_t begin = (groups.size() * task) / numTasks;
+        size_t end = (groups.size() * (task + 1)) / numTasks;
+        for (size_t i = begin; i < end; ++i) fillDestination(groups[i]);
+    });
+
+    if (restoreFailed)
+    {
+        vsg::warn("generateLevel() unable to restore spilled points, level is incomplete.");
+        return false;
     }
+
     return !destination.empty();
 }
 
 vsg::ref_ptr<vsg::StateGroup> vsgPoints::createStateGroup(const vsgPoints::Settings& settings)
 {
+    // with sharedObjects the texture, shaders and pipeline of datasets with matching settings are shared rather than each dataset creating its own
+    auto sharedObjects = settings.options ? settings.options->sharedObjects : vsg::ref_ptr<vsg::SharedObjects>();
+
     auto textureData = vsgPoints::createParticleImage(64);
     auto shaderSet = vsgPoints::createPointsFlatShadedShaderSet(settings.options);
+    if (sharedObjects)
+    {
+        sharedObjects->share(textureData);
+        sharedObjects->share(shaderSet);
+    }
+
     auto config = vsg::GraphicsPipelineConfig::create(shaderSet);
     bool blending = false;
 
@@ -211,20 +589,56 @@ vsg::ref_ptr<vsg::StateGroup> vsgPoints::createStateGroup(const vsgPoints::Setti
 
     config->accept(sps);
 
-    config->init();
+    if (sharedObjects)
+    {
+        sharedObjects->share(config, [](auto gpc) { gpc->init(); });
+    }
+    else
+    {
+        config->init();
+    }
 
     // create StateGroup as the root of the scene/command graph to hold the GraphicsPipeline, and binding of Descriptors to decorate the whole graph
     auto stateGroup = vsg::StateGroup::create();
 
-    config->copyTo(stateGroup);
+    config->copyTo(stateGroup, sharedObjects);
 
     return stateGroup;
 }
 
-vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoints::Levels::reverse_iterator level_itr, vsgPoints::Levels::reverse_iterator end_itr, vsgPoints::Key key, vsg::dbox& bound, bool root)
+double vsgPoints::geometricError(const vsgPoints::Settings& settings, const vsgPoints::Key& key, const vsg::dbox& bound, size_t numPoints)
+{
+    double brickPrecision = settings.precision * static_cast<double>(key.w);
+    if (!bound.valid() || numPoints == 0) return brickPrecision;
+
+    vsg::dvec3 size = bound.max - bound.min;
+    std::array<double, 3> dimensions{size.x, size.y, size.z};
+    std::sort(dimensions.begin(), dimensions.end());
+
+    double spacing = std::sqrt((dimensions[2] * dimensions[1]) / static_cast<double>(numPoints));
+    return std::max(brickPrecision, spacing);
+}
+
+double vsgPoints::screenSpaceErrorRatio(const vsgPoints::Settings& settings, double geometricError, double radius)
+{
+    // a sphere of radius at a distance where the screen spans a height of viewHeight occupies a screen height ratio of 2 * radius / viewHeight,
+    // while geometricError spans geometricError * screenHeight / viewHeight pixels, so it reaches pixelError at a ratio of:
+    return (2.0 * radius * settings.pixelError) / (geometricError * settings.screenHeight);
+}
+
+vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoints::Levels::reverse_iterator level_itr, vsgPoints::Levels::reverse_iterator end_itr, vsgPoints::Key key, vsg::dbox& bound, bool root, const SubtreeNodes* subtrees, TileArchiveWriter* archive)
 {
     if (level_itr == end_itr) return {};
 
+    if (subtrees)
+    {
+        if (auto subtree_itr = subtrees->find(key); subtree_itr != subtrees->end())
+        {
+            bound.add(subtree_itr->second.second);
+            return subtree_itr->second.first;
+        }
+    }
+
     auto& bricks = *level_itr;
     auto itr = bricks->find(key);
     if (itr == bricks->end())
@@ -239,31 +653,81 @@ vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoi
 
     if (next_itr != end_itr)
     {
+        vsgPoints::Key subkey{key.x * 2, key.y * 2, key.z * 2, key.w / 2};
+
+        std::array<vsg::ref_ptr<vsg::Node>, 8> subtiles;
+        std::array<vsg::dbox, 8> subtile_bounds;
+        auto createSubtile = [&](size_t i) {
+            vsgPoints::Key offset(static_cast<int32_t>(i & 1), static_cast<int32_t>((i >> 1) & 1), static_cast<int32_t>((i >> 2) & 1), 0);
+            subtiles[i] = subtile(settings, next_itr, end_itr, subkey + offset, subtile_bounds[i], false, subtrees, archive);
+        };
+
+        // fan the subtiles out across the settings.operationThreads while they have levels of their own to recurse into and tiles to write,
+        // the results are gathered in a fixed order so the scene graph and files written are the same as a serial build.
+        auto child_next_itr = next_itr;
+        ++child_next_itr;
+        if (child_next_itr != end_itr)
+        {
+            parallel_for(settings, subtiles.size(), createSubtile);
+        }
+        else if (settings.packThreshold > 0 || settings.drawIndirect)
+        {
+            // the children are leaves, so pack together those holding few points, or all of them to be drawn indirectly
+            Bricks::SortedBricks leaves;
+            std::vector<size_t> slots;
+            for (size_t i = 0; i < subtiles.size(); ++i)
+            {
+                vsgPoints::Key childKey = subkey + vsgPoints::Key(static_cast<int32_t>(i & 1), static_cast<int32_t>((i >> 1) & 1), static_cast<int32_t>((i >> 2) & 1), 0);
+                if (subtrees && subtrees->count(childKey) > 0)
+                {
+                    createSubtile(i);
+                }
+                else if (auto child_itr = (*next_itr)->find(childKey); child_itr != (*next_itr)->end())
+                {
+                    leaves.push_back(*child_itr);
+                    slots.push_back(i);
+                }
+            }
+
+            auto leafNodes = createLeafNodes(settings, leaves);
+            for (size_t j = 0; j < slots.size(); ++j)
+            {
+                subtiles[slots[j]] = leafNodes[j].first;
+                subtile_bounds[slots[j]] = leafNodes[j].second;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < subtiles.size(); ++i) createSubtile(i);
+        }
+
         std::array<vsg::ref_ptr<vsg::Node>, 8> children;
         size_t num_children = 0;
 
-        vsgPoints::Key subkey{key.x * 2, key.y * 2, key.z * 2, key.w / 2};
-
         vsg::dbox subtiles_bound;
-
-        if (auto child = subtile(settings, next_itr, end_itr, subkey, subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(1, 0, 0, 0), subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(0, 1, 0, 0), subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(1, 1, 0, 0), subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(0, 0, 1, 0), subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(1, 0, 1, 0), subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(0, 1, 1, 0), subtiles_bound)) children[num_children++] = child;
-        if (auto child = subtile(settings, next_itr, end_itr, subkey + vsgPoints::Key(1, 1, 1, 0), subtiles_bound)) children[num_children++] = child;
+        for (size_t i = 0; i < subtiles.size(); ++i)
+        {
+            if (subtiles[i]) children[num_children++] = subtiles[i];
+            subtiles_bound.add(subtile_bounds[i]);
+        }
 
         vsg::dbox local_bound;
         auto brick_node = brick->createRendering(settings, key, local_bound);
+        size_t numBrickPoints = brick->size();
+
+        // the brick_node now holds the points and the brick won't be visited again, so with a memory budget let them go along with the tile
+        if (settings.memoryBudget > 0 && settings.createType == CREATE_PAGEDLOD) brick->clear();
 
         if (num_children == 0)
         {
-            //vsg::info("Warning: unable to set PagedLOD bounds, key = ",key,", num_children = ", num_children, ", brick_node = ", brick_node, ", brick->points.size() = ",  brick->points.size());
+            //vsg::info("Warning: unable to set PagedLOD bounds, key = ",key,", num_children = ", num_children, ", brick_node = ", brick_node, ", brick->size() = ",  brick->size());
+            bound.add(local_bound);
             return brick_node;
         }
 
+        // in additive mode the points of this brick are no longer contained in the children so need to be included in the bound
+        if (settings.additive) subtiles_bound.add(local_bound);
+
         double transition = settings.transition;
         vsg::dsphere bs;
 
@@ -290,17 +754,18 @@ vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoi
             bs.radius = vsg::length(local_bound.max - local_bound.max) * 0.5;
         }
 
-        if (settings.createType == CREATE_PAGEDLOD)
+        // switch to the children once the spacing of this brick's points projects to more than settings.pixelError pixels
+        if (settings.pixelError > 0.0 && bs.radius > 0.0)
         {
-            vsg::Path path = vsg::make_string(settings.path, "/", key.w, "/", key.z, "/", key.y);
-            vsg::Path filename = vsg::make_string(key.x, settings.extension);
-            vsg::Path full_path = path / filename;
-
-            vsg::makeDirectory(path);
+            transition = screenSpaceErrorRatio(settings, geometricError(settings, key, local_bound, numBrickPoints), bs.radius);
+        }
 
+        if (settings.createType == CREATE_PAGEDLOD)
+        {
+            vsg::ref_ptr<vsg::Node> tile;
             if (num_children == 1)
             {
-                vsg::write(children[0], full_path);
+                tile = children[0];
             }
             else
             {
@@ -309,24 +774,70 @@ vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoi
                 {
                     group->addChild(children[i]);
                 }
-                vsg::write(group, full_path);
+                tile = group;
+            }
+
+            vsg::Path tile_filename;
+            if (archive)
+            {
+                std::string tile_name = vsg::make_string(key.w, "/", key.z, "/", key.y, "/", key.x, settings.extension);
+                if (!archive->add(tile_name, tile)) vsg::warn("unable to add tile ", tile_name, " to tile archive ", archive->filename);
+                tile_filename = archive->tileFilename(tile_name, root);
+            }
+            else
+            {
+                vsg::Path path = vsg::make_string(settings.path, "/", key.w, "/", key.z, "/", key.y);
+                vsg::Path filename = vsg::make_string(key.x, settings.extension);
+                vsg::Path full_path = path / filename;
+
+                {
+                    // makeDirectory checks for and creates each parent directory in turn, so serialize calls from the subtile tasks
+                    std::scoped_lock<std::mutex> lock(s_makeDirectoryMutex);
+                    vsg::makeDirectory(path);
+                }
+
+                if (auto writer = createTileWriter(settings))
+                {
+                    writer->write(tile, full_path);
+                }
+                else
+                {
+                    vsg::write(tile, full_path);
+                }
+
+                if (root)
+                {
+                    tile_filename = full_path;
+                }
+                else
+                {
+                    tile_filename = vsg::Path("../../../..") / full_path;
+                }
             }
 
             auto plod = vsg::PagedLOD::create();
             plod->bound = bs;
             plod->children[0] = vsg::PagedLOD::Child{transition, {}};  // external child visible when its bound occupies more than ~1/4 of the height of the window
-            plod->children[1] = vsg::PagedLOD::Child{0.0, brick_node}; // visible always
-
-            if (root)
+            if (settings.additive)
             {
-                plod->filename = full_path;
+                plod->children[1] = vsg::PagedLOD::Child{0.0, vsg::Node::create()}; // placeholder, the brick_node is drawn alongside the PagedLOD
             }
             else
             {
-                plod->filename = vsg::Path("../../../..") / full_path;
+                plod->children[1] = vsg::PagedLOD::Child{0.0, brick_node}; // visible always
             }
 
-            //vsg::info("plod ", key, " ", brick, " plod ", plod, ", brick->points.size() = ",  brick->points.size());
+            plod->filename = tile_filename;
+
+            //vsg::info("plod ", key, " ", brick, " plod ", plod, ", brick->size() = ",  brick->size());
+
+            if (settings.additive && brick_node)
+            {
+                auto group = vsg::Group::create();
+                group->addChild(brick_node);
+                group->addChild(plod);
+                return group;
+            }
 
             return plod;
         }
@@ -351,9 +862,21 @@ vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoi
             auto lod = vsg::LOD::create();
             lod->bound = bs;
             lod->addChild(vsg::LOD::Child{transition, child_node}); // high res child
-            lod->addChild(vsg::LOD::Child{0.0, brick_node});        // lower res child
 
-            //vsg::info("lod ", key, " ", brick, " lod ", lod, ", brick->points.size() = ",  brick->points.size());
+            if (settings.additive)
+            {
+                // the children only refine this brick so are drawn in addition to it
+                if (!brick_node) return lod;
+
+                auto group = vsg::Group::create();
+                group->addChild(brick_node);
+                group->addChild(lod);
+                return group;
+            }
+
+            lod->addChild(vsg::LOD::Child{0.0, brick_node}); // lower res child
+
+            //vsg::info("lod ", key, " ", brick, " lod ", lod, ", brick->size() = ",  brick->size());
 
             return lod;
         }
@@ -361,14 +884,15 @@ vsg::ref_ptr<vsg::Node> vsgPoints::subtile(vsgPoints::Settings& settings, vsgPoi
     else
     {
         auto leaf = brick->createRendering(settings, key, bound);
-        //vsg::info("leaf key  ",key, " ", brick, " leaf ", leaf, ", bound ", bound, ", brick->points.size() = ",  brick->points.size());
+        if (settings.memoryBudget > 0 && settings.createType == CREATE_PAGEDLOD) brick->clear();
+        //vsg::info("leaf key  ",key, " ", brick, " leaf ", leaf, ", bound ", bound, ", brick->size() = ",  brick->size());
         return leaf;
     }
 
     return vsg::Node::create();
 }
 
-vsg::ref_ptr<vsg::Node> vsgPoints::createPagedLOD(vsgPoints::Levels& levels, vsgPoints::Settings& settings)
+vsg::ref_ptr<vsg::Node> vsgPoints::createPagedLOD(vsgPoints::Levels& levels, vsgPoints::Settings& settings, const SubtreeNodes* subtrees, TileArchiveWriter* archive)
 {
     if (levels.empty()) return {};
 
@@ -385,7 +909,7 @@ vsg::ref_ptr<vsg::Node> vsgPoints::createPagedLOD(vsgPoints::Levels& levels, vsg
     if (levels.size() == 1)
     {
         vsg::dbox bound;
-        for (auto& [key, brick] : *(levels.back()))
+        for (auto& [key, brick] : levels.back()->sorted())
         {
             auto tile = brick->createRendering(settings, key, bound);
             stateGroup->addChild(tile);
@@ -402,16 +926,372 @@ vsg::ref_ptr<vsg::Node> vsgPoints::createPagedLOD(vsgPoints::Levels& levels, vsg
     auto& root_level = *current_itr;
     vsg::debug("root level ", root_level->size());
 
-    for (auto& [key, brick] : *root_level)
+    // the archive may already have been opened by createPagedLODStreamed() for the tiles of the subtrees
+    vsg::ref_ptr<TileArchiveWriter> openedArchive;
+    if (settings.archiveTiles && !archive)
     {
-        vsg::debug("root key = ", key, " ", brick);
+        openedArchive = openTileArchive(settings);
+        if (!openedArchive) return {};
+        archive = openedArchive.get();
+    }
+
+    auto root_bricks = root_level->sorted();
+    std::vector<vsg::ref_ptr<vsg::Node>> root_children(root_bricks.size());
+    parallel_for(settings, root_bricks.size(), [&](size_t i) {
+        vsg::debug("root key = ", root_bricks[i].first, " ", root_bricks[i].second);
         vsg::dbox bound;
-        if (auto child = subtile(settings, current_itr, levels.rend(), key, bound, true))
+        root_children[i] = subtile(settings, current_itr, levels.rend(), root_bricks[i].first, bound, true, subtrees, archive);
+    });
+
+    for (auto& child : root_children)
+    {
+        if (child)
         {
             vsg::debug("root child ", child);
             stateGroup->addChild(child);
         }
     }
 
+    if (openedArchive && !closeTileArchive(*openedArchive)) return {};
+
     return stateGroup;
 }
+
+vsg::ref_ptr<vsg::Node> vsgPoints::createPagedLODStreamed(vsgPoints::Bricks& bricks, vsgPoints::Settings& settings, vsgPoints::BrickStore* store)
+{
+    // the keys are positive, so the levels converge on a single root brick once the largest key component has been halved down to 0
+    int32_t maxKey = 0;
+    for (auto& [key, brick] : bricks)
+    {
+        maxKey = std::max(maxKey, std::max(std::max(key.x, key.y), key.z));
+    }
+
+    uint32_t numLevels = 1;
+    while ((maxKey >> (numLevels - 1)) > 0) ++numLevels;
+
+    // too few levels to split into subtrees so build the whole database in one go
+    uint32_t subtreeLevels = settings.subtreeLevels;
+    if (subtreeLevels == 0 || numLevels <= subtreeLevels)
+    {
+        vsgPoints::Levels levels;
+        levels.push_back(Bricks::create());
+        levels.back()->swap(bricks);
+
+        while (levels.back()->size() > 1)
+        {
+            auto& source = levels.back();
+            levels.push_back(vsgPoints::Bricks::create());
+            if (!vsgPoints::generateLevel(*source, *levels.back(), settings)) return {};
+        }
+
+        if (store && !store->add(levels, settings)) return {};
+
+        return createPagedLOD(levels, settings);
+    }
+
+    // group the full resolution bricks by the root brick of the subtree they belong to
+    int32_t shift = static_cast<int32_t>(subtreeLevels - 1);
+    KeyMap<vsg::ref_ptr<Bricks>> subtreeBricks;
+    for (auto& [key, brick] : bricks)
+    {
+        auto& subtree = subtreeBricks[Key{key.x >> shift, key.y >> shift, key.z >> shift, key.w << shift}];
+        if (!subtree) subtree = Bricks::create();
+        (*subtree)[key] = brick;
+    }
+    bricks.clear();
+
+    std::vector<Key> subtreeKeys;
+    subtreeKeys.reserve(subtreeBricks.size());
+    for (auto& [key, subtree] : subtreeBricks) subtreeKeys.push_back(key);
+    std::sort(subtreeKeys.begin(), subtreeKeys.end());
+
+    vsg::ref_ptr<TileArchiveWriter> archive;
+    if (settings.archiveTiles)
+    {
+        archive = openTileArchive(settings);
+        if (!archive) return {};
+    }
+
+    // the subtree root bricks stay in the upper levels as placeholders for the subtree nodes, and the level above them is
+    // accumulated from each subtree's root brick in key order so it matches generating the level from all of them at once.
+    vsgPoints::Levels upperLevels;
+    upperLevels.push_back(Bricks::create());
+    upperLevels.push_back(Bricks::create());
+    auto& subtreeRoots = *upperLevels.front();
+    auto& firstUpperLevel = *upperLevels.back();
+
+    SubtreeNodes subtreeNodes;
+    for (auto& subtreeKey : subtreeKeys)
+    {
+        vsgPoints::Levels levels;
+        levels.push_back(subtreeBricks.find(subtreeKey)->second);
+        subtreeBricks.find(subtreeKey)->second = {};
+
+        for (uint32_t l = 1; l < subtreeLevels; ++l)
+        {
+            auto& source = levels.back();
+            levels.push_back(vsgPoints::Bricks::create());
+            if (!vsgPoints::generateLevel(*source, *levels.back(), settings)) return {};
+        }
+
+        // generate the subtree's contribution to the level above before creating the subtree, as in additive mode this moves points out of its root brick
+        auto parentLevel = Bricks::create();
+        if (!vsgPoints::generateLevel(*levels.back(), *parentLevel, settings) || !firstUpperLevel.merge(*parentLevel)) return {};
+
+        subtreeRoots[subtreeKey] = Brick::create(settings.bits);
+
+        if (store && !store->add(levels, settings)) return {};
+
+        auto& [node, bound] = subtreeNodes[subtreeKey];
+        node = subtile(settings, levels.rbegin(), levels.rend(), subtreeKey, bound, false, nullptr, archive.get());
+    }
+
+    while (upperLevels.back()->size() > 1)
+    {
+        auto& source = upperLevels.back();
+        upperLevels.push_back(vsgPoints::Bricks::create());
+        if (!vsgPoints::generateLevel(*source, *upperLevels.back(), settings)) return {};
+    }
+
+    if (store)
+    {
+        // the front level only holds placeholders for the subtree root bricks, which have already been stored
+        for (auto itr = std::next(upperLevels.begin()); itr != upperLevels.end(); ++itr)
+        {
+            for (auto& [key, brick] : (*itr)->sorted())
+            {
+                if (!store->add(key, *brick, settings)) return {};
+            }
+        }
+    }
+
+    auto root = createPagedLOD(upperLevels, settings, &subtreeNodes, archive.get());
+
+    if (archive && !closeTileArchive(*archive)) return {};
+
+    return root;
+}
+
+namespace
+{
+    // read a previously written tile of a paged database
+    vsg::ref_ptr<vsg::Node> readTile(const Settings& settings, const vsg::Path& filename)
+    {
+        if (settings.extension == PointsTile::tileExtension())
+        {
+            return PointsTile::create()->read(filename, settings.options).cast<vsg::Node>();
+        }
+        return vsg::read_cast<vsg::Node>(filename, settings.options);
+    }
+} // namespace
+
+vsg::ref_ptr<vsg::Node> vsgPoints::appendToPagedLOD(vsg::ref_ptr<vsgPoints::Bricks> bricks, vsg::ref_ptr<vsgPoints::Settings> settings)
+{
+    if (bricks->empty())
+    {
+        vsg::warn("appendToPagedLOD(", bricks, ", ", settings, ") bricks is empty(), nothing to append.");
+        return {};
+    }
+
+    if (settings->createType != CREATE_PAGEDLOD || settings->additive || settings->archiveTiles)
+    {
+        vsg::warn("appendToPagedLOD() only supports CREATE_PAGEDLOD databases created without additive or archiveTiles.");
+        return {};
+    }
+
+    auto store = BrickStore::create(vsg::make_string(settings->path, BrickStore::storeExtension()));
+    if (!store->readManifest())
+    {
+        vsg::warn("appendToPagedLOD() unable to read brick store ", store->directory, ", the database must be created with Settings::storeBricks.");
+        return {};
+    }
+
+    if (!store->compatible(*settings))
+    {
+        vsg::warn("appendToPagedLOD() settings don't match the quantization and tile options ", settings->path, " was created with.");
+        return {};
+    }
+
+    auto rootKey = store->rootKey();
+    auto keyOrigin = store->keyOrigin;
+
+    // move the new bricks into the key space of the database, checking whether they all fit within the extents of the root brick
+    bool contained = rootKey.w > 1;
+    auto level = Bricks::create();
+    for (auto& [key, brick] : bricks->sorted())
+    {
+        Key local_key{key.x - keyOrigin.x, key.y - keyOrigin.y, key.z - keyOrigin.z, key.w};
+        if (local_key.x < 0 || local_key.y < 0 || local_key.z < 0 || local_key.x >= rootKey.w || local_key.y >= rootKey.w || local_key.z >= rootKey.w) contained = false;
+        (*level)[local_key] = brick;
+    }
+
+    auto rebuild = [&]() -> vsg::ref_ptr<vsg::Node> {
+        vsg::info("appendToPagedLOD() rebuilding ", settings->path, " from the stored and new points.");
+
+        auto combined = Bricks::create(bricks->settings);
+        size_t loaded = 0;
+        for (auto& [key, entry] : store->entries)
+        {
+            if (key.w != 1) continue;
+
+            auto brick = store->read(key);
+            if (!brick) return {};
+
+            (*combined)[Key{key.x + keyOrigin.x, key.y + keyOrigin.y, key.z + keyOrigin.z, key.w}] = brick;
+
+            loaded += brick->memoryUsed();
+            if (settings->memoryBudget > 0 && loaded > settings->memoryBudget)
+            {
+                combined->spill(*settings, settings->memoryBudget / 2);
+                loaded = combined->memoryUsed();
+            }
+        }
+        if (!combined->merge(*bricks)) return {};
+
+        settings->storeBricks = true;
+        return createSceneGraph(combined, settings);
+    };
+
+    if (!contained) return rebuild();
+
+    // full resolution level, the new points are appended to the points already stored for each brick
+    Levels levels;
+    for (auto& [key, brick] : *level)
+    {
+        if (!brick->restore()) return {};
+
+        // bricks in the manifest that can't be read mean the store no longer matches the database
+        auto stored = store->read(key);
+        if (stored)
+        {
+            stored->append(*brick);
+            brick = stored;
+        }
+        else if (store->entries.find(key) != store->entries.end())
+        {
+            return {};
+        }
+    }
+    levels.push_back(level);
+
+    // regenerate the ancestors of the modified bricks, reading their unmodified siblings back from the store. The full resolution
+    // siblings are kept so the tiles holding them are recreated from the bricks, as their nodes may have been packed together.
+    vsg::ref_ptr<Bricks> leafSiblings;
+    while (levels.back()->begin()->first.w < rootKey.w)
+    {
+        auto& current = *levels.back();
+
+        auto source = Bricks::create();
+        for (auto& [key, brick] : current) (*source)[key] = brick;
+
+        for (auto& [key, brick] : current)
+        {
+            for (int32_t i = 0; i < 8; ++i)
+            {
+                Key sibling{(key.x & ~1) + (i & 1), (key.y & ~1) + ((i >> 1) & 1), (key.z & ~1) + ((i >> 2) & 1), key.w};
+                if (source->find(sibling) != source->end()) continue;
+                if (auto stored = store->read(sibling)) (*source)[sibling] = stored;
+                else if (store->entries.find(sibling) != store->entries.end()) return {};
+            }
+        }
+
+        if (!leafSiblings) leafSiblings = source;
+
+        levels.push_back(Bricks::create());
+        if (!generateLevel(*source, *levels.back(), *settings)) return {};
+    }
+
+    // the tiles of the modified bricks hold the nodes of their unmodified children, so read these back from the existing tiles before any are replaced.
+    // subtile() writes a tile's children in octant order, with a single child written directly rather than within a Group.
+    SubtreeNodes nodes;
+    auto lower_itr = levels.begin();
+    for (auto level_itr = std::next(levels.begin()); level_itr != levels.end(); ++level_itr, ++lower_itr)
+    {
+        auto& lower = **lower_itr;
+        for (auto& [key, brick] : **level_itr)
+        {
+            if (key.w == 2 || store->entries.find(key) == store->entries.end()) continue;
+
+            std::vector<Key> children;
+            bool reuse = false;
+            for (int32_t i = 0; i < 8; ++i)
+            {
+                Key child(key.x * 2 + (i & 1), key.y * 2 + ((i >> 1) & 1), key.z * 2 + ((i >> 2) & 1), key.w / 2);
+                if (store->entries.find(child) == store->entries.end()) continue;
+
+                children.push_back(child);
+                if (lower.find(child) == lower.end()) reuse = true;
+            }
+            if (!reuse) continue;
+
+            vsg::Path filename = vsg::make_string(settings->path, "/", key.w, "/", key.z, "/", key.y, "/", key.x, settings->extension);
+            auto tile = readTile(*settings, filename);
+
+            std::vector<vsg::ref_ptr<vsg::Node>> tile_children;
+            if (auto group = tile.cast<vsg::Group>(); group && children.size() > 1)
+            {
+                tile_children = group->children;
+            }
+            else if (tile)
+            {
+                tile_children.push_back(tile);
+            }
+
+            if (tile_children.size() != children.size())
+            {
+                vsg::warn("appendToPagedLOD() unable to reuse tile ", filename, ".");
+                return rebuild();
+            }
+
+            for (size_t i = 0; i < children.size(); ++i)
+            {
+                if (lower.find(children[i]) == lower.end()) nodes[children[i]] = {tile_children[i], store->entries[children[i]].bound};
+            }
+        }
+    }
+
+    // update the store before creating the tiles as creating them reorders the bricks, and releases them when there is a memory budget
+    if (!store->add(levels, *settings)) return {};
+
+    // recreate the modified tiles from the finest level up, each taking the nodes of its children from those reused or already recreated
+    for (auto& current : levels)
+    {
+        auto w = current->begin()->first.w;
+        if (w == 1 && leafSiblings) continue;
+
+        Levels tileLevels;
+        if (w == 2) tileLevels.push_back(leafSiblings);
+        else if (w > 2) tileLevels.push_back(Bricks::create());
+        tileLevels.push_back(current);
+
+        auto current_bricks = current->sorted();
+        std::vector<std::pair<vsg::ref_ptr<vsg::Node>, vsg::dbox>> current_nodes(current_bricks.size());
+        parallel_for(*settings, current_bricks.size(), [&](size_t i) {
+            auto& key = current_bricks[i].first;
+            current_nodes[i].first = subtile(*settings, tileLevels.rbegin(), tileLevels.rend(), key, current_nodes[i].second, key == rootKey, &nodes);
+        });
+
+        for (size_t i = 0; i < current_bricks.size(); ++i)
+        {
+            nodes[current_bricks[i].first] = current_nodes[i];
+        }
+    }
+
+    if (!store->writeManifest()) return {};
+
+    double brickSize = settings->precision * pow(2.0, static_cast<double>(settings->bits));
+    vsg::dvec3 offset(static_cast<double>(keyOrigin.x) * brickSize,
+                      static_cast<double>(keyOrigin.y) * brickSize,
+                      static_cast<double>(keyOrigin.z) * brickSize);
+
+    settings->offset = vsg::dvec3(0.0, 0.0, 0.0);
+
+    auto transform = vsg::MatrixTransform::create();
+    transform->matrix = vsg::translate(offset);
+
+    auto stateGroup = createStateGroup(*settings);
+    stateGroup->addChild(nodes[rootKey].first);
+    transform->addChild(stateGroup);
+
+    return transform;
+}
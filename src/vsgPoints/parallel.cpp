@@ -0,0 +1,97 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/parallel.h>
+
+#include <vsg/threading/Latch.h>
+#include <vsg/threading/OperationThreads.h>
+
+#include <exception>
+#include <mutex>
+
+using namespace vsgPoints;
+
+namespace
+{
+    /// first exception thrown by the tasks of a parallel_for(), rethrown on the calling thread once all the tasks have completed
+    struct TaskException
+    {
+        std::mutex mutex;
+        std::exception_ptr exception;
+
+        void capture()
+        {
+            std::scoped_lock<std::mutex> lock(mutex);
+            if (!exception) exception = std::current_exception();
+        }
+    };
+
+    struct IndexOperation : public vsg::Inherit<vsg::Operation, IndexOperation>
+    {
+        IndexOperation(const std::function<void(size_t)>& in_func, size_t in_index, vsg::ref_ptr<vsg::Latch> in_latch, TaskException& in_taskException) :
+            func(in_func),
+            index(in_index),
+            latch(in_latch),
+            taskException(in_taskException) {}
+
+        const std::function<void(size_t)>& func;
+        size_t index;
+        vsg::ref_ptr<vsg::Latch> latch;
+        TaskException& taskException;
+
+        void run() override
+        {
+            // count down however func exits so parallel_for() never waits on a task that has already finished
+            struct CountDown
+            {
+                vsg::Latch& latch;
+                ~CountDown() { latch.count_down(); }
+            } countDown{*latch};
+
+            try
+            {
+                func(index);
+            }
+            catch (...)
+            {
+                taskException.capture();
+            }
+        }
+    };
+} // namespace
+
+size_t vsgPoints::concurrency(const Settings& settings)
+{
+    return settings.operationThreads ? settings.operationThreads->threads.size() + 1 : 1;
+}
+
+void vsgPoints::parallel_for(const Settings& settings, size_t count, const std::function<void(size_t index)>& func)
+{
+    if (!settings.operationThreads || count <= 1)
+    {
+        for (size_t i = 0; i < count; ++i) func(i);
+        return;
+    }
+
+    TaskException taskException;
+    auto latch = vsg::Latch::create(static_cast<int>(count));
+    for (size_t i = 0; i < count; ++i)
+    {
+        settings.operationThreads->add(IndexOperation::create(func, i, latch, taskException));
+    }
+
+    // use this thread to help run the operations, then wait for any still running on the other threads to complete
+    settings.operationThreads->run();
+    latch->wait();
+
+    if (taskException.exception) std::rethrow_exception(taskException.exception);
+}
@@ -0,0 +1,63 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/parallel.h>
+#include <vsgPoints/read.h>
+
+#include <vsg/io/Logger.h>
+#include <vsg/io/read.h>
+
+#include <algorithm>
+
+using namespace vsgPoints;
+
+vsg::ref_ptr<Bricks> vsgPoints::readBricks(const vsg::Paths& filenames, vsg::ref_ptr<Settings> settings, vsg::ref_ptr<const vsg::Options> options, std::vector<vsg::ref_ptr<vsg::Node>>* nodes)
+{
+    size_t numConcurrentReads = std::max(size_t(1), std::min(filenames.size(), concurrency(*settings)));
+
+    std::vector<vsg::ref_ptr<vsg::Object>> objects(filenames.size());
+    parallel_for(*settings, filenames.size(), [&](size_t i) {
+        auto fileSettings = Settings::create(*settings);
+        fileSettings->bound = {};
+        fileSettings->memoryBudget = settings->memoryBudget / numConcurrentReads;
+
+        auto fileOptions = options ? vsg::Options::create(*options) : vsg::Options::create();
+        fileOptions->setObject("settings", fileSettings);
+
+        objects[i] = vsg::read(filenames[i], fileOptions);
+    });
+
+    // merge in filename order so the result doesn't depend on the order the reads complete in
+    auto bricks = Bricks::create(settings);
+    for (size_t i = 0; i < objects.size(); ++i)
+    {
+        if (auto fileBricks = objects[i].cast<Bricks>())
+        {
+            if (!bricks->merge(*fileBricks))
+            {
+                vsg::warn("readBricks() unable to restore spilled points read from ", filenames[i]);
+                return {};
+            }
+        }
+        else if (auto node = objects[i].cast<vsg::Node>(); node && nodes)
+        {
+            nodes->push_back(node);
+        }
+        else
+        {
+            vsg::warn("readBricks() unable to read points from ", filenames[i]);
+        }
+        objects[i] = {};
+    }
+
+    return bricks;
+}
@@ -0,0 +1,129 @@
+/* <editor-fold desc="MIT License">
+
+Copyright(c) 2026 Robert Osfield
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+</editor-fold> */
+
+#include <vsgPoints/Brick.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace vsgPoints;
+
+namespace
+{
+    int failures = 0;
+
+    void check(bool result, const char* description)
+    {
+        if (!result)
+        {
+            std::cerr << "FAILED: " << description << std::endl;
+            ++failures;
+        }
+    }
+
+    bool equal(float lhs, double rhs)
+    {
+        return std::abs(static_cast<double>(lhs) - rhs) <= 1e-6 * std::max(1.0, std::abs(rhs));
+    }
+
+    vsg::ref_ptr<Brick> createBrick(uint32_t bits, size_t numPoints, uint16_t seed)
+    {
+        auto brick = Brick::create(bits);
+        for (size_t i = 0; i < numPoints; ++i)
+        {
+            uint16_t v = static_cast<uint16_t>((seed + i * 7) % 1024);
+            brick->add(vsg::usvec3(v, static_cast<uint16_t>(1023 - v), static_cast<uint16_t>(i % 16)), vsg::ubvec4(static_cast<uint8_t>(seed), static_cast<uint8_t>(i), static_cast<uint8_t>(i >> 8), 255));
+        }
+        return brick;
+    }
+} // namespace
+
+// headless check of the arrays and draw commands that Brick::packBricks() creates for a set of bricks, as drawn by createPackedRendering()
+int main()
+{
+    auto settings = Settings::create();
+    settings->bits = 10;
+    settings->precision = 0.01;
+    settings->pointSize = 4.0f;
+    settings->offset = vsg::dvec3(1.0, 2.0, 3.0);
+
+    // an empty brick between the others checks that empty bricks are skipped without consuming a draw or instance
+    std::vector<std::pair<Key, vsg::ref_ptr<Brick>>> bricks{
+        {Key{0, 0, 0, 1}, createBrick(settings->bits, 100, 1)},
+        {Key{1, 0, 0, 1}, createBrick(settings->bits, 0, 2)},
+        {Key{1, 1, 0, 1}, createBrick(settings->bits, 250, 3)},
+        {Key{0, 1, 1, 1}, createBrick(settings->bits, 1, 4)}};
+
+    auto packed = Brick::packBricks(*settings, bricks);
+
+    check(packed.vertices && packed.colors && packed.normals && packed.positionScales && packed.pointSizes && packed.drawCommands, "packBricks() creates all the arrays");
+    if (failures > 0) return EXIT_FAILURE;
+
+    size_t numDraws = 3;
+    size_t numPoints = 351;
+    check(packed.drawCommands->size() == numDraws, "a draw command per non empty brick");
+    check(packed.positionScales->size() == numDraws && packed.pointSizes->size() == numDraws && packed.normals->size() == numDraws, "an instance value per draw");
+    check(packed.vertices->valueCount() == numPoints && packed.colors->size() == numPoints, "the packed arrays hold all the points");
+    check(packed.vertices->properties.format == VK_FORMAT_A2R10G10B10_UNORM_PACK32, "10 bit vertices are packed in the A2R10G10B10 format");
+    if (failures > 0) return EXIT_FAILURE;
+
+    uint32_t instance = 0;
+    uint32_t firstVertex = 0;
+    vsg::dbox bound;
+    for (auto& [key, brick] : bricks)
+    {
+        if (brick->empty()) continue;
+
+        auto& dc = packed.drawCommands->at(instance);
+        check(dc.vertexCount == brick->size(), "draw vertexCount matches the brick's size");
+        check(dc.instanceCount == 1, "draw instanceCount is 1");
+        check(dc.firstVertex == firstVertex, "draw firstVertex follows the previous brick's points");
+        check(dc.firstInstance == instance, "draw firstInstance selects the brick's instance values");
+
+        double brickPrecision = settings->precision * static_cast<double>(key.w);
+        double brickSize = brickPrecision * std::pow(2.0, static_cast<double>(settings->bits));
+        vsg::dvec3 position = vsg::dvec3(key.x, key.y, key.z) * brickSize - settings->offset;
+
+        auto& positionScale = packed.positionScales->at(instance);
+        check(equal(positionScale.x, position.x) && equal(positionScale.y, position.y) && equal(positionScale.z, position.z), "positionScale holds the brick's position");
+        check(equal(positionScale.w, brickSize), "positionScale holds the brick's size");
+
+        auto& pointSize = packed.pointSizes->at(instance);
+        check(equal(pointSize.x, brickPrecision * settings->pointSize) && equal(pointSize.y, brickPrecision), "pointSize holds the brick's point size and precision");
+
+        // 10 bit vertices are packed as x << 20 | y << 10 | z
+        auto packedVertices = packed.vertices.cast<vsg::uintArray>();
+        bool pointsMatch = true;
+        for (size_t i = 0; i < brick->size(); ++i)
+        {
+            auto expected = brick->point(i);
+            auto v = packedVertices->at(firstVertex + i);
+            vsg::usvec3 actual(static_cast<uint16_t>((v >> 20) & 0x3ff), static_cast<uint16_t>((v >> 10) & 0x3ff), static_cast<uint16_t>(v & 0x3ff));
+            if (actual != expected.v || packed.colors->at(firstVertex + i) != expected.c) pointsMatch = false;
+        }
+        check(pointsMatch, "packed vertices and colors match the brick's points");
+
+        bound.add(brick->computeBound(*settings, key));
+
+        firstVertex += dc.vertexCount;
+        ++instance;
+    }
+
+    check(packed.bound.min == bound.min && packed.bound.max == bound.max, "bound includes all the bricks");
+
+    if (failures > 0) return EXIT_FAILURE;
+
+    std::cout << "packBricks passed" << std::endl;
+    return EXIT_SUCCESS;
+}